@@ -0,0 +1,161 @@
+// Headless broadphase benchmark: compares the spatial hash grid, sweep-and-prune and the
+// AABB tree against the all-pairs loop PhysicsSystem used to run, for scenes of falling cubes.
+
+#include "physics/aabb_tree_broadphase.hpp"
+#include "physics/spatial_hash_grid.hpp"
+#include "physics/sweep_and_prune.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace yellowstone;
+
+namespace {
+
+	std::vector<AABB> generateBounds(size_t count, float density) {
+		// Spread cubes of the demo's size (0.3 - 0.4) through a box whose volume scales with count
+		float side = std::cbrt(static_cast<float>(count) / density);
+		std::mt19937 rng{1234};
+		std::uniform_real_distribution<float> position{0.0f, side};
+		std::uniform_real_distribution<float> size{0.3f, 0.4f};
+
+		std::vector<AABB> bounds(count);
+		for (auto& box : bounds) {
+			glm::vec3 center{position(rng), -position(rng), position(rng)};
+			glm::vec3 halfExtents{size(rng) * 0.5f};
+			box = {center - halfExtents, center + halfExtents};
+		}
+		return bounds;
+	}
+
+	size_t bruteForce(const std::vector<AABB>& bounds) {
+		size_t overlaps = 0;
+		for (size_t i = 0; i < bounds.size(); i++) {
+			for (size_t j = i + 1; j < bounds.size(); j++) {
+				if (bounds[i].overlaps(bounds[j])) overlaps++;
+			}
+		}
+		return overlaps;
+	}
+
+	// Nudge a fraction of the bodies, like a mostly settled pile with a few cubes still moving
+	void moveBodies(std::vector<AABB>& bounds, std::vector<uint32_t>& moved, float fraction, std::mt19937& rng) {
+		std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+		std::uniform_real_distribution<float> step{-0.02f, 0.02f};
+		moved.clear();
+		for (uint32_t i = 0; i < bounds.size(); i++) {
+			if (unit(rng) >= fraction) continue;
+			glm::vec3 offset{step(rng), step(rng), step(rng)};
+			bounds[i].min += offset;
+			bounds[i].max += offset;
+			moved.push_back(i);
+		}
+	}
+
+	template <typename F>
+	double timeMs(int iterations, F&& f) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			f();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	float cellSize = argc > 1 ? std::strtof(argv[1], nullptr) : 1.0f;
+	const size_t counts[] = {1000, 10000, 100000};
+	const size_t bruteForceLimit = 10000;
+
+	std::printf("cell size %.2f\n", cellSize);
+	std::printf("%10s %12s %12s %12s %14s %16s %16s\n", "bodies", "candidates", "overlaps", "grid (ms)", "all-pairs (ms)", "sap 5% moving", "tree 5% moving");
+
+	SpatialHashGrid grid{cellSize};
+	SweepAndPrune sweepAndPrune;
+	AABBTreeBroadphase aabbTree;
+	std::vector<BodyPair> pairs;
+	std::vector<uint32_t> moved;
+	std::mt19937 rng{42};
+
+	for (size_t count : counts) {
+		auto bounds = generateBounds(count, 2.0f);
+
+		size_t overlaps = 0;
+		double gridMs = timeMs(10, [&]() {
+			grid.update(bounds, moved);
+			pairs.clear();
+			grid.findPairs(pairs);
+			overlaps = 0;
+			for (const auto& pair : pairs) {
+				if (bounds[pair.first].overlaps(bounds[pair.second])) overlaps++;
+			}
+		});
+		size_t candidates = pairs.size();
+
+		double bruteMs = -1.0;
+		if (count <= bruteForceLimit) {
+			size_t expected = 0;
+			bruteMs = timeMs(1, [&]() { expected = bruteForce(bounds); });
+			if (expected != overlaps) {
+				std::fprintf(stderr, "mismatch at %zu bodies: grid found %zu overlaps, all-pairs %zu\n", count, overlaps, expected);
+				return EXIT_FAILURE;
+			}
+		}
+
+		// Incremental broadphases must agree with a fresh grid after their run of moves
+		auto countOverlaps = [&](Broadphase& broadphase) {
+			moved.clear();
+			broadphase.update(bounds, moved);
+			std::vector<BodyPair> found;
+			broadphase.findPairs(found);
+			size_t n = 0;
+			for (const auto& pair : found) {
+				if (bounds[pair.first].overlaps(bounds[pair.second])) n++;
+			}
+			return n;
+		};
+		auto verify = [&](Broadphase& broadphase, const char* name) {
+			size_t expected = countOverlaps(grid);
+			size_t found = countOverlaps(broadphase);
+			if (found != expected) {
+				std::fprintf(stderr, "mismatch at %zu bodies: %s found %zu overlaps, grid %zu\n", count, name, found, expected);
+				return false;
+			}
+			return true;
+		};
+
+		// Sweep-and-prune and the tree are timed over a run of coherent frames after the initial build
+		sweepAndPrune.reset();
+		sweepAndPrune.update(bounds, moved);
+		double sapMs = timeMs(10, [&]() {
+			moveBodies(bounds, moved, 0.05f, rng);
+			sweepAndPrune.update(bounds, moved);
+		});
+		if (!verify(sweepAndPrune, "sweep-and-prune")) return EXIT_FAILURE;
+
+		aabbTree.reset();
+		aabbTree.update(bounds, moved);
+		pairs.clear();
+		aabbTree.findPairs(pairs);
+		double treeMs = timeMs(10, [&]() {
+			moveBodies(bounds, moved, 0.05f, rng);
+			aabbTree.update(bounds, moved);
+			pairs.clear();
+			aabbTree.findPairs(pairs);
+		});
+		if (!verify(aabbTree, "tree")) return EXIT_FAILURE;
+
+		if (bruteMs >= 0.0) {
+			std::printf("%10zu %12zu %12zu %12.3f %14.3f %16.3f %16.3f\n", count, candidates, overlaps, gridMs, bruteMs, sapMs, treeMs);
+		} else {
+			std::printf("%10zu %12zu %12zu %12.3f %14s %16.3f %16.3f\n", count, candidates, overlaps, gridMs, "skipped", sapMs, treeMs);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+// Headless check that steady-state frames don't touch the heap. Runs App's SimulationStage
+// (demo scene, physics thread, scheduler, transform hierarchy, render snapshots through the
+// frame queue) with allocation tracking compiled in. Prints per-frame allocation stats as JSON
+// and exits with 1 if any frame after the warm-up allocated.
+//
+// usage: bench_frame_allocations [--frames N] [--warmup N] [--rate FPS] [--threads N] [--physics-threads N]
+
+#include "systems/simulation_stage.hpp"
+#include "systems/system_scheduler.hpp"
+#include "yellowstone_allocation_tracker.hpp"
+#include "yellowstone_frame_arena.hpp"
+#include "yellowstone_thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace yellowstone;
+
+namespace {
+
+	const char* const usage = "usage: bench_frame_allocations [--frames N] [--warmup N] [--rate FPS] [--threads N] [--physics-threads N]\n";
+
+	// App::PHYSICS_STEP_RATE and App::FRAME_QUEUE_DEPTH; app.hpp pulls in Vulkan
+	constexpr float physicsStepRate = 120.0f;
+	constexpr uint32_t frameQueueDepth = 2;
+
+	struct Options {
+		uint32_t frames = 600;
+		uint32_t warmup = 300;
+		float rate = 60.0f;
+		uint32_t threads = YellowstoneThreadPool::defaultWorkerCount();
+		uint32_t physicsThreads = YellowstoneThreadPool::defaultWorkerCount();
+		bool help = false;
+	};
+
+	Options parseOptions(int argc, char** argv) {
+		Options options;
+		for (int i = 1; i < argc; i += 2) {
+			const char* name = argv[i];
+			if (std::strcmp(name, "--help") == 0 || std::strcmp(name, "-h") == 0) {
+				options.help = true;
+				return options;
+			}
+			if (i + 1 == argc) throw std::runtime_error(std::string("missing value for ") + name);
+			const char* value = argv[i + 1];
+			if (std::strcmp(name, "--frames") == 0) options.frames = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--warmup") == 0) options.warmup = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--rate") == 0) options.rate = std::strtof(value, nullptr);
+			else if (std::strcmp(name, "--threads") == 0) options.threads = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--physics-threads") == 0) options.physicsThreads = std::strtoul(value, nullptr, 10);
+			else throw std::runtime_error(std::string("unknown option ") + name);
+		}
+		return options;
+	}
+
+	struct CameraResource {};
+
+}
+
+int main(int argc, char** argv) {
+	if (!YellowstoneAllocationTracker::enabled) {
+		std::fprintf(stderr, "built without YELLOWSTONE_TRACK_ALLOCATIONS\n");
+		return 1;
+	}
+
+	Options options;
+	try {
+		options = parseOptions(argc, argv);
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "%s\n%s", e.what(), usage);
+		return 1;
+	}
+	if (options.help) {
+		std::printf("%s", usage);
+		return 0;
+	}
+
+	YellowstoneThreadPool threadPool{options.threads};
+	SimulationStage simulation{threadPool, options.physicsThreads, physicsStepRate, frameQueueDepth};
+	simulation.loadDemoScene(nullptr, nullptr);
+	simulation.start();
+	YellowstoneFrameQueue<RenderSnapshot>& frameQueue = simulation.getFrameQueue();
+
+	// Stands in for recording: reads every object the way SimpleRenderSystem does
+	const RenderSnapshot* frame = nullptr;
+	float checksum = 0.0f;
+	SystemScheduler renderScheduler;
+	renderScheduler.addSystem("objects", SystemAccess{}.read<RenderSnapshotResource>().write<CameraResource>(), [&]() {
+		for (const RenderObject& object : frame->objects) {
+			checksum += object.matrices.modelMatrix[3][1];
+		}
+	});
+
+	auto frameDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / std::max(options.rate, 1.0f)));
+	auto nextFrame = std::chrono::steady_clock::now();
+	uint64_t steadyAllocations = 0;
+	uint64_t steadyBytes = 0;
+	uint32_t allocatingFrames = 0;
+	uint64_t warmupAllocations = 0;
+	// From the start of a frame's simulation to the end of its recording, as App reports it
+	float latencySum = 0.0f;
+	float latencyMax = 0.0f;
+	for (uint32_t i = 0; i < options.frames; i++) {
+		RenderSnapshot* read = frameQueue.beginRead(std::chrono::milliseconds(1000));
+		if (read == nullptr) {
+			std::fprintf(stderr, "simulation stalled\n");
+			return 1;
+		}
+		{
+			AllocationScope allocationScope{"render"};
+			YellowstoneFrameArena::beginFrame(i);
+			frame = read;
+			renderScheduler.run(threadPool);
+			frame = nullptr;
+		}
+		if (i >= options.warmup) {
+			float latency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - read->simulationStart).count();
+			latencySum += latency;
+			latencyMax = std::max(latencyMax, latency);
+		}
+		frameQueue.endRead(read);
+
+		AllocationStats stats = YellowstoneAllocationTracker::collectFrame();
+		if (i < options.warmup) {
+			warmupAllocations += stats.allocations;
+		} else if (stats.allocations > 0) {
+			steadyAllocations += stats.allocations;
+			steadyBytes += stats.bytes;
+			allocatingFrames++;
+			std::fprintf(stderr, "frame %u: ", i);
+			YellowstoneAllocationTracker::print(stats, stderr);
+		}
+
+		nextFrame += frameDuration;
+		std::this_thread::sleep_until(nextFrame);
+	}
+
+	simulation.stop();
+
+	uint32_t steadyFrames = options.frames - std::min(options.frames, options.warmup);
+	std::printf("{\n");
+	std::printf("  \"frames\": %u,\n", options.frames);
+	std::printf("  \"warmup_frames\": %u,\n", options.warmup);
+	std::printf("  \"threads\": %u,\n", options.threads);
+	std::printf("  \"physics_threads\": %u,\n", options.physicsThreads);
+	std::printf("  \"physics_steps\": %llu,\n", static_cast<unsigned long long>(simulation.getPhysicsThread().getStepCount()));
+	std::printf("  \"warmup_allocations\": %llu,\n", static_cast<unsigned long long>(warmupAllocations));
+	std::printf("  \"steady_allocations\": {\"total\": %llu, \"bytes\": %llu, \"frames\": %u, \"of\": %u},\n",
+		static_cast<unsigned long long>(steadyAllocations), static_cast<unsigned long long>(steadyBytes), allocatingFrames, steadyFrames);
+	std::printf("  \"latency_ms\": {\"mean\": %.3f, \"max\": %.3f},\n", steadyFrames > 0 ? latencySum / steadyFrames : 0.0f, latencyMax);
+	std::printf("  \"checksum\": %.3f\n", checksum);
+	std::printf("}\n");
+	return steadyAllocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// Job system benchmark: measures scheduling overhead as empty jobs per second, for jobs
+// submitted from the main thread, jobs spawned from inside other jobs, jobs released in waves
+// by submitAfter and parallelFor. Exits with 1 if a submitAfter job ran before its dependency.
+//
+// usage: bench_jobs [--threads N] [--jobs N]
+// Without --threads it runs with 0, 1, 2, 4, ... workers up to one per hardware thread.
+
+#include "yellowstone_thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace yellowstone;
+
+namespace {
+
+	const char* const usage = "usage: bench_jobs [--threads N] [--jobs N]\n";
+
+	// Jobs released together by one submitAfter dependency
+	constexpr uint32_t jobsPerWave = 256;
+
+	template <typename F>
+	double jobsPerSecond(uint32_t jobs, F&& f) {
+		auto start = std::chrono::high_resolution_clock::now();
+		f();
+		auto end = std::chrono::high_resolution_clock::now();
+		return jobs / std::chrono::duration<double>(end - start).count();
+	}
+
+	// Empty jobs submitted from outside the pool, the main thread helping while it waits
+	double submitFromMain(YellowstoneThreadPool& pool, uint32_t jobs) {
+		return jobsPerSecond(jobs, [&]() {
+			JobCounter counter;
+			for (uint32_t i = 0; i < jobs; i++) {
+				pool.submit([]() {}, &counter);
+			}
+			pool.wait(counter);
+		});
+	}
+
+	// Jobs that each submit a batch of empty jobs, which go to the worker's own deque
+	double submitFromJobs(YellowstoneThreadPool& pool, uint32_t jobs) {
+		const uint32_t batch = 256;
+		uint32_t spawners = jobs / batch;
+		return jobsPerSecond(spawners * (batch + 1), [&]() {
+			JobCounter counter;
+			for (uint32_t i = 0; i < spawners; i++) {
+				pool.submit([&pool, &counter]() {
+					for (uint32_t j = 0; j < batch; j++) {
+						pool.submit([]() {}, &counter);
+					}
+				}, &counter);
+			}
+			pool.wait(counter);
+		});
+	}
+
+	// Waves of empty jobs, each submitted after the previous wave's counter. Clears 'ordered'
+	// if a job starts before every job of the wave before it has run.
+	double submitAfterWaves(YellowstoneThreadPool& pool, uint32_t jobs, bool& ordered) {
+		uint32_t waves = std::max(jobs / jobsPerWave, 1u);
+		std::unique_ptr<JobCounter[]> counters{new JobCounter[waves]};
+		std::unique_ptr<std::atomic<uint32_t>[]> finished{new std::atomic<uint32_t>[waves]()};
+		std::atomic<bool> inOrder{true};
+		double rate = jobsPerSecond(waves * jobsPerWave, [&]() {
+			for (uint32_t w = 0; w < waves; w++) {
+				for (uint32_t j = 0; j < jobsPerWave; j++) {
+					auto job = [&finished, &inOrder, w]() {
+						if (w > 0 && finished[w - 1].load(std::memory_order_acquire) != jobsPerWave) {
+							inOrder.store(false, std::memory_order_relaxed);
+						}
+						finished[w].fetch_add(1, std::memory_order_release);
+					};
+					if (w == 0) {
+						pool.submit(job, &counters[w]);
+					} else {
+						pool.submitAfter(counters[w - 1], job, &counters[w]);
+					}
+				}
+			}
+			pool.wait(counters[waves - 1]);
+		});
+		// The last wave finishing doesn't mean the earlier counters are released yet
+		for (uint32_t w = 0; w < waves; w++) {
+			pool.wait(counters[w]);
+		}
+		ordered = ordered && inOrder.load();
+		return rate;
+	}
+
+	// One index per job
+	double parallelForEmpty(YellowstoneThreadPool& pool, uint32_t jobs) {
+		return jobsPerSecond(jobs, [&]() {
+			pool.parallelFor(jobs, [](uint32_t) {});
+		});
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::vector<uint32_t> threadCounts;
+	uint32_t jobs = 1000000;
+	for (int i = 1; i < argc; i += 2) {
+		if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+			std::printf("%s", usage);
+			return 0;
+		}
+		bool known = std::strcmp(argv[i], "--threads") == 0 || std::strcmp(argv[i], "--jobs") == 0;
+		if (!known || i + 1 == argc) {
+			std::fprintf(stderr, "%s", usage);
+			return 1;
+		}
+		if (std::strcmp(argv[i], "--threads") == 0) threadCounts.push_back(std::strtoul(argv[i + 1], nullptr, 10));
+		else jobs = std::strtoul(argv[i + 1], nullptr, 10);
+	}
+	if (threadCounts.empty()) {
+		uint32_t maxWorkers = YellowstoneThreadPool::defaultWorkerCount();
+		threadCounts.push_back(0);
+		for (uint32_t count = 1; count < maxWorkers; count *= 2) {
+			threadCounts.push_back(count);
+		}
+		if (maxWorkers > 0) {
+			threadCounts.push_back(maxWorkers);
+		}
+	}
+
+	bool ordered = true;
+	std::printf("%8s %18s %18s %18s %18s\n", "workers", "main (jobs/s)", "nested (jobs/s)", "after (jobs/s)", "parallelFor (jobs/s)");
+	for (uint32_t workers : threadCounts) {
+		YellowstoneThreadPool pool{workers};
+		double fromMain = submitFromMain(pool, jobs);
+		double nested = submitFromJobs(pool, jobs);
+		double after = submitAfterWaves(pool, jobs, ordered);
+		std::printf("%8u %18.0f %18.0f %18.0f %18.0f\n", workers, fromMain, nested, after, parallelForEmpty(pool, jobs));
+	}
+	if (!ordered) {
+		std::fprintf(stderr, "a job submitted with submitAfter ran before its dependency finished\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,203 @@
+// Headless physics benchmark: steps PhysicsSystem over a generated scene of cubes and prints
+// step time percentiles and broadphase/solver work as JSON, for tracking regressions.
+//
+// usage: bench_physics [--layout rain|pile|grid|explosion] [--bodies N] [--frames N]
+//                      [--broadphase grid|sap|tree] [--threads N] [--iterations N] [--seed N]
+
+#include "systems/physics_system.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace yellowstone;
+
+namespace {
+
+	const char* const usage =
+		"usage: bench_physics [--layout rain|pile|grid|explosion] [--bodies N] [--frames N]\n"
+		"                     [--broadphase grid|sap|tree] [--threads N] [--iterations N] [--seed N]\n";
+
+	struct Options {
+		std::string layout = "rain";
+		std::string broadphase = "tree";
+		uint32_t bodies = 10000;
+		uint32_t frames = 600;
+		uint32_t threads = YellowstoneThreadPool::defaultWorkerCount();
+		uint32_t iterations = 8;
+		uint32_t seed = 1234;
+		float deltaTime = 1.0f / 120.0f;
+		bool help = false;
+	};
+
+	Options parseOptions(int argc, char** argv) {
+		Options options;
+		for (int i = 1; i < argc; i += 2) {
+			const char* name = argv[i];
+			if (std::strcmp(name, "--help") == 0 || std::strcmp(name, "-h") == 0) {
+				options.help = true;
+				return options;
+			}
+			if (i + 1 == argc) throw std::runtime_error(std::string("missing value for ") + name);
+			const char* value = argv[i + 1];
+			if (std::strcmp(name, "--layout") == 0) options.layout = value;
+			else if (std::strcmp(name, "--broadphase") == 0) options.broadphase = value;
+			else if (std::strcmp(name, "--bodies") == 0) options.bodies = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--frames") == 0) options.frames = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--threads") == 0) options.threads = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--iterations") == 0) options.iterations = std::strtoul(value, nullptr, 10);
+			else if (std::strcmp(name, "--seed") == 0) options.seed = std::strtoul(value, nullptr, 10);
+			else throw std::runtime_error(std::string("unknown option ") + name);
+		}
+		return options;
+	}
+
+	BroadphaseType parseBroadphase(const std::string& name) {
+		if (name == "grid") return BroadphaseType::SpatialHash;
+		if (name == "sap") return BroadphaseType::SweepAndPrune;
+		if (name == "tree") return BroadphaseType::AABBTree;
+		throw std::runtime_error("unknown broadphase " + name);
+	}
+
+	void addCube(YellowstoneRegistry& registry, const glm::vec3& position, const glm::vec3& velocity, float size) {
+		TransformComponent transform{};
+		transform.translation = position;
+		transform.scale = glm::vec3{size};
+		registry.create(transform, PhysicsComponent{velocity, 1.0f});
+	}
+
+	// Y points down, so cubes start at negative Y above the ground plane at y = 0
+	void generateScene(const Options& options, YellowstoneRegistry& registry) {
+		std::mt19937 rng{options.seed};
+		std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+		std::uniform_real_distribution<float> size{0.3f, 0.4f};
+		uint32_t count = options.bodies;
+
+		if (options.layout == "rain") {
+			// Scattered cubes falling onto a floor sized for a few layers
+			float side = std::sqrt(static_cast<float>(count)) * 0.6f;
+			float height = std::max(5.0f, static_cast<float>(count) / (side * side) * 2.0f);
+			for (uint32_t i = 0; i < count; i++) {
+				glm::vec3 position{unit(rng) * side, -1.0f - unit(rng) * height, unit(rng) * side};
+				addCube(registry, position, {0.0f, unit(rng) * 2.0f, 0.0f}, size(rng));
+			}
+		} else if (options.layout == "pile") {
+			// Touching column of cubes on a small footprint, the worst case for the solver
+			uint32_t footprint = std::max(1u, static_cast<uint32_t>(std::cbrt(static_cast<float>(count)) * 2.0f));
+			const float spacing = 0.4f;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t x = i % footprint;
+				uint32_t z = (i / footprint) % footprint;
+				uint32_t y = i / (footprint * footprint);
+				glm::vec3 position{x * spacing, -0.2f - y * spacing, z * spacing};
+				addCube(registry, position, glm::vec3{0.0f}, spacing);
+			}
+		} else if (options.layout == "grid") {
+			// Regular lattice with gaps that falls and lands all at once
+			uint32_t side = std::max(1u, static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(count)))));
+			const float spacing = 0.6f;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t x = i % side;
+				uint32_t z = (i / side) % side;
+				uint32_t y = i / (side * side);
+				glm::vec3 position{x * spacing, -1.0f - y * spacing, z * spacing};
+				addCube(registry, position, glm::vec3{0.0f}, 0.3f);
+			}
+		} else if (options.layout == "explosion") {
+			// Dense ball flying apart, so pairs are created and destroyed every step
+			float radius = std::cbrt(static_cast<float>(count)) * 0.2f;
+			glm::vec3 center{0.0f, -radius - 2.0f, 0.0f};
+			for (uint32_t i = 0; i < count; i++) {
+				glm::vec3 direction{unit(rng) * 2.0f - 1.0f, unit(rng) * 2.0f - 1.0f, unit(rng) * 2.0f - 1.0f};
+				float length = glm::length(direction);
+				direction = length > 0.0f ? direction / length : glm::vec3{0.0f, -1.0f, 0.0f};
+				float distance = unit(rng) * radius;
+				addCube(registry, center + direction * distance, direction * (2.0f + unit(rng) * 8.0f), size(rng));
+			}
+		} else {
+			throw std::runtime_error("unknown layout " + options.layout);
+		}
+	}
+
+	double percentile(const std::vector<double>& sorted, double fraction) {
+		if (sorted.empty()) return 0.0;
+		size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	try {
+		options = parseOptions(argc, argv);
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "%s\n%s", e.what(), usage);
+		return 1;
+	}
+	if (options.help) {
+		std::printf("%s", usage);
+		return 0;
+	}
+
+	YellowstoneRegistry registry;
+	PhysicsSystem physicsSystem;
+	try {
+		generateScene(options, registry);
+		physicsSystem.setBroadphase(parseBroadphase(options.broadphase));
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	physicsSystem.setWorkerThreadCount(options.threads);
+	physicsSystem.setSolverIterations(options.iterations);
+	physicsSystem.syncBodies(registry);
+
+	std::vector<double> stepMilliseconds;
+	stepMilliseconds.reserve(options.frames);
+	uint64_t pairTests = 0;
+	uint64_t contacts = 0;
+	double finalResidual = 0.0;
+
+	for (uint32_t frame = 0; frame < options.frames; frame++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		physicsSystem.step(options.deltaTime);
+		auto end = std::chrono::high_resolution_clock::now();
+		stepMilliseconds.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+		const StepStats& stats = physicsSystem.getStepStats();
+		pairTests += stats.pairTests;
+		contacts += stats.contacts;
+		finalResidual += physicsSystem.getSolverStats().finalResidual;
+	}
+
+	double total = 0.0;
+	for (double ms : stepMilliseconds) total += ms;
+	std::vector<double> sorted = stepMilliseconds;
+	std::sort(sorted.begin(), sorted.end());
+	double frames = std::max(1u, options.frames);
+
+	std::printf("{\n");
+	std::printf("  \"layout\": \"%s\",\n", options.layout.c_str());
+	std::printf("  \"broadphase\": \"%s\",\n", options.broadphase.c_str());
+	std::printf("  \"integrator\": \"%s\",\n", getIntegratorBackendName());
+	std::printf("  \"bodies\": %u,\n", options.bodies);
+	std::printf("  \"frames\": %u,\n", options.frames);
+	std::printf("  \"threads\": %u,\n", options.threads);
+	std::printf("  \"solver_iterations\": %u,\n", options.iterations);
+	std::printf("  \"step_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+		total / frames, percentile(sorted, 0.5), percentile(sorted, 0.99), sorted.empty() ? 0.0 : sorted.back());
+	std::printf("  \"pair_tests\": {\"total\": %llu, \"per_frame\": %.1f},\n", static_cast<unsigned long long>(pairTests), pairTests / frames);
+	std::printf("  \"contacts\": {\"total\": %llu, \"per_frame\": %.1f},\n", static_cast<unsigned long long>(contacts), contacts / frames);
+	std::printf("  \"mean_final_residual\": %.6f,\n", finalResidual / frames);
+	std::printf("  \"awake_bodies_at_end\": %u\n", physicsSystem.getAwakeBodyCount());
+	std::printf("}\n");
+	return 0;
+}
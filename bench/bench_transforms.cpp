@@ -0,0 +1,119 @@
+// Transform benchmark: compares building model/normal matrices one TransformComponent at a
+// time, from Euler angles and from orientation quaternions, against the batched kernel over
+// structure-of-arrays input, and checks they agree.
+
+#include "ecs/components.hpp"
+#include "ecs/transform_batch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace yellowstone;
+
+namespace {
+
+	struct TransformData {
+		std::vector<float> translation[3];
+		std::vector<float> rotation[3];
+		std::vector<float> scale[3];
+		std::vector<glm::quat> orientation;
+
+		TransformArrays arrays() const {
+			return {
+				translation[0].data(), translation[1].data(), translation[2].data(),
+				rotation[0].data(), rotation[1].data(), rotation[2].data(),
+				scale[0].data(), scale[1].data(), scale[2].data()};
+		}
+	};
+
+	TransformData generateTransforms(size_t count) {
+		std::mt19937 rng{1234};
+		std::uniform_real_distribution<float> position{-100.0f, 100.0f};
+		std::uniform_real_distribution<float> angle{-6.3f, 6.3f};
+		std::uniform_real_distribution<float> size{0.1f, 4.0f};
+
+		TransformData data;
+		for (int axis = 0; axis < 3; axis++) {
+			data.translation[axis].resize(count);
+			data.rotation[axis].resize(count);
+			data.scale[axis].resize(count);
+			for (size_t i = 0; i < count; i++) {
+				data.translation[axis][i] = position(rng);
+				data.rotation[axis][i] = angle(rng);
+				data.scale[axis][i] = size(rng);
+			}
+		}
+		data.orientation.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			data.orientation[i] = eulerToQuaternion({data.rotation[0][i], data.rotation[1][i], data.rotation[2][i]});
+		}
+		return data;
+	}
+
+	// What the renderer did per object before caching: build both matrices from scratch
+	void computePerObject(const TransformData& data, bool useOrientation, std::vector<TransformMatrices>& output) {
+		for (size_t i = 0; i < output.size(); i++) {
+			TransformComponent transform{};
+			transform.translation = {data.translation[0][i], data.translation[1][i], data.translation[2][i]};
+			if (useOrientation) {
+				transform.orientation = data.orientation[i];
+			} else {
+				transform.rotation = {data.rotation[0][i], data.rotation[1][i], data.rotation[2][i]};
+			}
+			transform.scale = {data.scale[0][i], data.scale[1][i], data.scale[2][i]};
+			output[i].modelMatrix = transform.mat4();
+			output[i].normalMatrix = glm::mat4{transform.normalMatrix()};
+		}
+	}
+
+	float maxDifference(const std::vector<TransformMatrices>& a, const std::vector<TransformMatrices>& b) {
+		float largest = 0.0f;
+		for (size_t i = 0; i < a.size(); i++) {
+			const float* x = &a[i].modelMatrix[0][0];
+			const float* y = &b[i].modelMatrix[0][0];
+			for (size_t j = 0; j < sizeof(TransformMatrices) / sizeof(float); j++) {
+				largest = std::max(largest, std::abs(x[j] - y[j]));
+			}
+		}
+		return largest;
+	}
+
+	template <typename F>
+	double timeMs(int iterations, F&& f) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			f();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+	}
+
+}
+
+int main() {
+	const size_t counts[] = {10000, 1000000};
+
+	std::printf("backend %s\n", getTransformBatchBackendName());
+	std::printf("%10s %12s %16s %12s %10s %12s\n", "objects", "euler (ms)", "quaternion (ms)", "batch (ms)", "speedup", "max error");
+
+	for (size_t count : counts) {
+		TransformData data = generateTransforms(count);
+		TransformArrays arrays = data.arrays();
+		std::vector<TransformMatrices> reference(count);
+		std::vector<TransformMatrices> fromOrientation(count);
+		std::vector<TransformMatrices> batched(count);
+		int iterations = count > 100000 ? 10 : 200;
+
+		double eulerMs = timeMs(iterations, [&]() { computePerObject(data, false, reference); });
+		double quaternionMs = timeMs(iterations, [&]() { computePerObject(data, true, fromOrientation); });
+		double batchMs = timeMs(iterations, [&]() { computeTransformMatrices(arrays, count, batched.data()); });
+
+		float error = std::max(maxDifference(reference, fromOrientation), maxDifference(reference, batched));
+		std::printf("%10zu %12.3f %16.3f %12.3f %9.2fx %12.2e\n", count, eulerMs, quaternionMs, batchMs, eulerMs / batchMs, error);
+	}
+	return 0;
+}
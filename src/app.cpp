@@ -3,7 +3,8 @@
 #include "keyboard_movement_controller.hpp"
 #include "systems/simple_render_system.hpp"
 #include "systems/point_light_system.hpp"
-#include "systems/physics_system.hpp"
+#include "systems/system_scheduler.hpp"
+#include "yellowstone_allocation_tracker.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -11,9 +12,12 @@
 #include <glm/gtc/constants.hpp>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <stdexcept>
 #include <cassert>
 #include <chrono>
+#include <cstdio>
+#include <thread>
 
 
 namespace yellowstone {
@@ -26,6 +30,29 @@ namespace yellowstone {
 		alignas(16) glm::vec4 lightColor = glm::vec4(1.0f);
 	};
 
+	// Stand-ins for state outside the registry that frame systems share
+	struct CameraResource {};
+	struct UniformBufferResource {};
+	struct CommandBufferResource {};
+
+	namespace {
+
+		// Writes the systems on the scheduler's last critical path as "a > b > c" into text,
+		// truncating to size like snprintf
+		void formatCriticalPath(const SystemScheduler& scheduler, char* text, size_t size) {
+			size_t length = 0;
+			text[0] = '\0';
+			for (uint32_t system : scheduler.getCriticalPath()) {
+				if (length >= size) {
+					break;
+				}
+				int written = std::snprintf(text + length, size - length, length == 0 ? "%s" : " > %s", scheduler.getSystemName(system).c_str());
+				length += written > 0 ? static_cast<size_t>(written) : 0;
+			}
+		}
+
+	}
+
 	App::App() {
 		globalPool = YellowstoneDescriptorPool::Builder(yellowstoneDevice)
 			.setMaxSets(YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT)
@@ -61,17 +88,80 @@ namespace yellowstone {
 		}
 
 		SimpleRenderSystem simpleRenderSystem{ yellowstoneDevice, yellowstoneRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+		simpleRenderSystem.setGpuFrustumCulling(GPU_FRUSTUM_CULLING);
 		PointLightSystem pointLightSystem{ yellowstoneDevice, yellowstoneRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
-		PhysicsSystem physicsSystem{};
 		YellowstoneCamera camera{};
 		camera.setViewTarget(glm::vec3(-1.0f, -2.0f, -5.0f), glm::vec3(0.0f, 0.0f, 2.5f));
 
-		auto viewerObject = YellowstoneGameObject::createGameObject();
-		viewerObject.transform.translation.z = -2.5f;
+		// The viewer isn't an entity, it only needs a transform for the camera to follow
+		TransformComponent viewerTransform{};
+		viewerTransform.translation.z = -2.5f;
 		KeyboardMovementController cameraController{};
 
+		// Recording runs as systems with declared access, so the ones that don't conflict
+		// run at the same time. Everything they read from the simulation is in the snapshot.
+		// Every system after the camera writes the frame's command buffer and culling reads the
+		// camera, so for now they form a single chain. The critical path in the window title
+		// shows where that chain spends its time.
+		FrameInfo* frame = nullptr;
+		SystemScheduler renderScheduler;
+		renderScheduler.addSystem("camera", SystemAccess{}.write<CameraResource, UniformBufferResource>(), [&]() {
+			AllocationScope allocationScope{"ubo write"};
+			camera.setViewYXZ(viewerTransform.translation, viewerTransform.rotation);
+			camera.setPerspectiveProjection(glm::radians(50.0f), yellowstoneRenderer.getAspectRatio(), 0.1f, 100.0f);
+
+			GlobalUbo ubo{};
+			ubo.projection = camera.getProjectionMatrix();
+			ubo.view = camera.getViewMatrix();
+			uboBuffers[frame->frameIndex]->writeToBuffer(&ubo);
+			uboBuffers[frame->frameIndex]->flush();
+		});
+		// Systems writing the command buffer record in the order they are added. Culling
+		// dispatches compute work, so it comes before the render pass begins.
+		renderScheduler.addSystem("cull", SystemAccess{}.read<CameraResource, RenderSnapshotResource>().write<CommandBufferResource>(), [&]() {
+			simpleRenderSystem.cullGameObjects(*frame, &threadPool);
+		});
+		// With secondary command buffers, each system below reserves its buffers in this order
+		// and the render pass executes them in the same order when it ends
+		renderScheduler.addSystem("begin render pass", SystemAccess{}.write<CommandBufferResource>(), [&]() {
+			yellowstoneRenderer.beginSwapChainRenderPass(frame->commandBuffer,
+				SECONDARY_COMMAND_BUFFERS ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+		});
+		renderScheduler.addSystem("objects", SystemAccess{}.read<RenderSnapshotResource>().write<CommandBufferResource>(), [&]() {
+			if (SECONDARY_COMMAND_BUFFERS) {
+				simpleRenderSystem.renderGameObjects(*frame, yellowstoneRenderer, threadPool);
+			} else {
+				simpleRenderSystem.renderGameObjects(*frame);
+			}
+		});
+		renderScheduler.addSystem("point lights", SystemAccess{}.write<CommandBufferResource>(), [&]() {
+			if (SECONDARY_COMMAND_BUFFERS) {
+				FrameInfo lightFrame = *frame;
+				lightFrame.commandBuffer = yellowstoneRenderer.beginSecondaryCommandBuffer(yellowstoneRenderer.reserveSecondaryCommandBuffers(1));
+				pointLightSystem.render(lightFrame);
+				yellowstoneRenderer.endSecondaryCommandBuffer(lightFrame.commandBuffer);
+			} else {
+				pointLightSystem.render(*frame);
+			}
+		});
+		renderScheduler.addSystem("end render pass", SystemAccess{}.write<CommandBufferResource>(), [&]() {
+			yellowstoneRenderer.endSwapChainRenderPass(frame->commandBuffer);
+		});
+
 		auto currentTime = std::chrono::high_resolution_clock::now();
 		bool rKeyPressedLastFrame = false;
+		simulation.start();
+		YellowstoneFrameQueue<RenderSnapshot>& frameQueue = simulation.getFrameQueue();
+
+		// Time from a snapshot starting to be simulated until its frame is submitted, which
+		// is what running the stages on separate threads adds on top of the GPU
+		auto reportStart = currentTime;
+		uint32_t reportFrames = 0;
+		float latencySum = 0.0f;
+		float latencyMax = 0.0f;
+		// Transform matrices rebuilt by the simulation stage, averaged per frame in the report
+		uint32_t matrixUpdates = 0;
+		uint64_t renderedFrames = 0;
 
         while (!yellowstoneWindow.shouldClose()) {
 			glfwPollEvents();
@@ -79,20 +169,25 @@ namespace yellowstone {
 			// Check for R key to reset simulation (only trigger once per press)
 			bool rKeyPressed = glfwGetKey(yellowstoneWindow.getWindow(), GLFW_KEY_R) == GLFW_PRESS;
 			if (rKeyPressed && !rKeyPressedLastFrame) {
-				resetSimulation();
+				simulation.requestReset();
 			}
 			rKeyPressedLastFrame = rKeyPressed;
 
         	auto newTime = std::chrono::high_resolution_clock::now();
         	float frameTime = std::chrono::duration<float>(newTime - currentTime).count();
         	currentTime = newTime;
-			// frameTime = std::min(frameTime, MAX_FRAME_TIME);
+			frameTime = std::min(frameTime, MAX_FRAME_TIME);
+
+			// GLFW input has to be read on the main thread
+        	cameraController.moveInPlaneXZ(yellowstoneWindow.getWindow(), frameTime, viewerTransform);
 
-        	cameraController.moveInPlaneXZ(yellowstoneWindow.getWindow(), frameTime, viewerObject);
-        	camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
+			// Time out now and then so window events keep being handled if the simulation stalls
+			RenderSnapshot* snapshot = frameQueue.beginRead(std::chrono::milliseconds(100));
+			if (snapshot == nullptr) {
+				continue;
+			}
 
-			float aspect = yellowstoneRenderer.getAspectRatio();
-            camera.setPerspectiveProjection(glm::radians(50.0f), aspect, 0.1f, 100.0f);
+			AllocationScope allocationScope{"render"};
 			if (auto commandBuffer = yellowstoneRenderer.beginFrame()) {
 				int frameIndex = yellowstoneRenderer.getFrameIndex();
 				FrameInfo frameInfo{
@@ -101,27 +196,61 @@ namespace yellowstone {
 					commandBuffer,
 					camera,
 					globalDescriptorSets[frameIndex],
-					gameObjects
+					*snapshot
 				};
+				frame = &frameInfo;
 
-				// Update
-				physicsSystem.update(frameInfo);
-				
-				GlobalUbo ubo{};
-				ubo.projection = camera.getProjectionMatrix();
-				ubo.view = camera.getViewMatrix();
-				uboBuffers[frameIndex]->writeToBuffer(&ubo);
-				uboBuffers[frameIndex]->flush();
-
-				// Render
-				yellowstoneRenderer.beginSwapChainRenderPass(commandBuffer);
-				simpleRenderSystem.renderGameObjects(frameInfo);
-				pointLightSystem.render(frameInfo);
-				yellowstoneRenderer.endSwapChainRenderPass(commandBuffer);
+				renderScheduler.run(threadPool);
 				yellowstoneRenderer.endFrame();
+				frame = nullptr;
+
+				float latency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - snapshot->simulationStart).count();
+				latencySum += latency;
+				latencyMax = std::max(latencyMax, latency);
+				matrixUpdates += snapshot->matrixUpdateCount;
+				reportFrames++;
+				renderedFrames++;
+
+				if constexpr (YellowstoneAllocationTracker::enabled) {
+					// Counts every thread, so this covers the simulation and physics work done meanwhile
+					AllocationStats allocations = YellowstoneAllocationTracker::collectFrame();
+					if (renderedFrames > ALLOCATION_WARMUP_FRAMES && allocations.allocations > 0) {
+						std::fprintf(stderr, "frame %llu: ", static_cast<unsigned long long>(renderedFrames));
+						YellowstoneAllocationTracker::print(allocations, stderr);
+					}
+				}
+			}
+			frameQueue.endRead(snapshot);
+
+			float reportSeconds = std::chrono::duration<float>(newTime - reportStart).count();
+			if (reportSeconds >= 1.0f && reportFrames > 0) {
+				RenderStats renderStats = simpleRenderSystem.getRenderStats();
+				renderStats += pointLightSystem.getRenderStats();
+				const SchedulerStats& schedulerStats = renderScheduler.getStats();
+				char criticalPath[160];
+				formatCriticalPath(renderScheduler, criticalPath, sizeof(criticalPath));
+				char title[512];
+				std::snprintf(title, sizeof(title), "%s - %.0f fps, latency %.1f ms (max %.1f ms), recording %.2f ms, critical path %.2f ms: %s, objects recorded in %.3f ms on %u secondary buffers, %u matrix updates, %u/%u visible, %u draws, binds %u pipeline %u set %u buffer",
+					WINDOW_TITLE, reportFrames / reportSeconds, latencySum / reportFrames, latencyMax,
+					schedulerStats.frameMilliseconds, schedulerStats.criticalPathMilliseconds, criticalPath,
+					simpleRenderSystem.getRecordingMilliseconds(), simpleRenderSystem.getRecordingBufferCount(),
+					matrixUpdates / reportFrames, simpleRenderSystem.getCullingStats().visibleObjects, simpleRenderSystem.getCullingStats().testedObjects,
+					renderStats.draws, renderStats.pipelineBinds, renderStats.descriptorBinds, renderStats.bufferBinds);
+				yellowstoneWindow.setTitle(title);
+				reportStart = newTime;
+				reportFrames = 0;
+				latencySum = 0.0f;
+				latencyMax = 0.0f;
+				matrixUpdates = 0;
+			}
+
+			if (MAX_FRAME_RATE > 0.0f) {
+				std::this_thread::sleep_until(newTime + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+					std::chrono::duration<float>(1.0f / MAX_FRAME_RATE)));
 			}
 		}
 
+		simulation.stop();
 		vkDeviceWaitIdle(yellowstoneDevice.device());
 	}
 
@@ -130,99 +259,6 @@ namespace yellowstone {
 		std::shared_ptr<YellowstoneModel> cubeModel = YellowstoneModel::createModelFromFile(yellowstoneDevice, "../src/models/cube.obj");
 		std::shared_ptr<YellowstoneModel> quadModel = YellowstoneModel::createModelFromFile(yellowstoneDevice, "../src/models/quad.obj");
 
-		// Create ground plane (static)
-		auto ground = YellowstoneGameObject::createGameObject();
-		ground.model = quadModel;
-		ground.transform.translation = {0.0f, 0.1f, 0.0f};
-		ground.transform.scale = glm::vec3(10.0f, 1.0f, 10.0f);
-		ground.physics.isStatic = true;
-		ground.color = glm::vec3(0.3f, 0.3f, 0.3f);
-		auto groundId = ground.getId();
-		initialStates[groundId] = {
-			ground.transform.translation,
-			ground.transform.scale,
-			ground.transform.rotation,
-			ground.physics.velocity,
-			ground.physics.mass,
-			ground.physics.isStatic
-		};
-		gameObjects.emplace(groundId, std::move(ground));
-
-		// Create falling cubes with different initial positions and velocities
-		// In Y-down system: negative Y is above ground, positive Y is below ground
-		for (int i = 0; i < 5; i++) {
-			auto cube = YellowstoneGameObject::createGameObject();
-			cube.model = cubeModel;
-			cube.transform.translation = {
-				-2.0f + i * 1.0f,
-				-5.0f - i * 0.5f,  // Negative Y = above ground
-				0.0f
-			};
-			cube.transform.scale = glm::vec3(0.3f, 0.3f, 0.3f);
-			cube.physics.velocity = glm::vec3(0.0f, 0.0f, 0.0f);
-			cube.physics.mass = 1.0f;
-			cube.physics.isStatic = false;
-			// Different colors for visual variety
-			cube.color = glm::vec3(
-				0.5f + (i % 3) * 0.2f,
-				0.3f + ((i + 1) % 3) * 0.2f,
-				0.4f + ((i + 2) % 3) * 0.2f
-			);
-			auto cubeId = cube.getId();
-			initialStates[cubeId] = {
-				cube.transform.translation,
-				cube.transform.scale,
-				cube.transform.rotation,
-				cube.physics.velocity,
-				cube.physics.mass,
-				cube.physics.isStatic
-			};
-			gameObjects.emplace(cubeId, std::move(cube));
-		}
-
-		// Add a few cubes with initial horizontal velocity
-		for (int i = 0; i < 3; i++) {
-			auto cube = YellowstoneGameObject::createGameObject();
-			cube.model = cubeModel;
-			cube.transform.translation = {
-				-1.5f + i * 1.5f,
-				-8.0f,  // Negative Y = above ground
-				1.0f
-			};
-			cube.transform.scale = glm::vec3(0.4f, 0.4f, 0.4f);
-			cube.physics.velocity = glm::vec3(0.5f - i * 0.5f, 0.0f, -0.3f);
-			cube.physics.mass = 1.5f;
-			cube.physics.isStatic = false;
-			cube.color = glm::vec3(0.8f, 0.2f, 0.2f);
-			auto cubeId = cube.getId();
-			initialStates[cubeId] = {
-				cube.transform.translation,
-				cube.transform.scale,
-				cube.transform.rotation,
-				cube.physics.velocity,
-				cube.physics.mass,
-				cube.physics.isStatic
-			};
-			gameObjects.emplace(cubeId, std::move(cube));
-		}
-	}
-
-	void App::resetSimulation() {
-		// Reset all game objects to their initial state
-		for (auto& kv : gameObjects) {
-			auto& obj = kv.second;
-			auto id = obj.getId();
-			
-			// Only reset if we have initial state stored
-			if (initialStates.find(id) != initialStates.end()) {
-				const auto& initialState = initialStates[id];
-				obj.transform.translation = initialState.translation;
-				obj.transform.scale = initialState.scale;
-				obj.transform.rotation = initialState.rotation;
-				obj.physics.velocity = initialState.velocity;
-				obj.physics.mass = initialState.mass;
-				obj.physics.isStatic = initialState.isStatic;
-			}
-		}
+		simulation.loadDemoScene(cubeModel, quadModel);
 	}
-}
\ No newline at end of file
+}
@@ -2,13 +2,16 @@
 
 #include "yellowstone_window.hpp"
 #include "yellowstone_device.hpp"
-#include "yellowstone_game_object.hpp"
+#include "ecs/components.hpp"
+#include "ecs/registry.hpp"
+#include "yellowstone_model.hpp"
 #include "yellowstone_renderer.hpp"
 #include "yellowstone_descriptors.hpp"
+#include "systems/simulation_stage.hpp"
+#include "yellowstone_thread_pool.hpp"
 
 #include <memory>
 #include <vector>
-#include <unordered_map>
 
 namespace yellowstone {
 
@@ -16,6 +19,25 @@ namespace yellowstone {
 	public:
 		static constexpr int WIDTH = 800;
 		static constexpr int HEIGHT = 600;
+		// Physics steps at a fixed rate on its own thread, independent of the render rate
+		static constexpr float PHYSICS_STEP_RATE = 120.0f;
+		// Caps the render loop; 0 leaves pacing to the swap chain's present mode
+		static constexpr float MAX_FRAME_RATE = 0.0f;
+		// Longest frame time fed to the camera controller after a stall
+		static constexpr float MAX_FRAME_TIME = 0.25f;
+		// Job system workers besides the main thread; -1 uses one per remaining hardware thread
+		static constexpr int WORKER_THREAD_COUNT = -1;
+		// Workers of the physics thread's own job system, counted the same way
+		static constexpr int PHYSICS_WORKER_THREAD_COUNT = -1;
+		// Simulated frames that may wait for the render stage; each adds up to a frame of latency
+		static constexpr uint32_t FRAME_QUEUE_DEPTH = 2;
+		// Record the render pass into secondary command buffers, objects in parallel across the job system
+		static constexpr bool SECONDARY_COMMAND_BUFFERS = true;
+		// Test objects against the frustum in the culling compute pass instead of on the CPU
+		static constexpr bool GPU_FRUSTUM_CULLING = false;
+		static constexpr const char* WINDOW_TITLE = " Game Engine";
+		// With VKENGINE_TRACK_ALLOCATIONS, frames after these that touch the heap are reported
+		static constexpr uint32_t ALLOCATION_WARMUP_FRAMES = 300;
 		void run();
 
 		App();
@@ -25,23 +47,19 @@ namespace yellowstone {
 
 	private:
 		void loadGameObjects();
-		void resetSimulation();
-
-		struct InitialState {
-			glm::vec3 translation;
-			glm::vec3 scale;
-			glm::vec3 rotation;
-			glm::vec3 velocity;
-			float mass;
-			bool isStatic;
-		};
-
-		YellowstoneWindow yellowstoneWindow{WIDTH, HEIGHT, " Game Engine"};
+
+		YellowstoneWindow yellowstoneWindow{WIDTH, HEIGHT, WINDOW_TITLE};
 		YellowstoneDevice yellowstoneDevice{yellowstoneWindow};
 		YellowstoneRenderer yellowstoneRenderer{yellowstoneWindow, yellowstoneDevice};
 		std::unique_ptr<YellowstoneDescriptorPool> globalPool{};
 
-		YellowstoneGameObject::Map gameObjects;
-		std::unordered_map<YellowstoneGameObject::id_t, InitialState> initialStates;
+		// Shared by the simulation and render stages' per-frame work; declared first so it
+		// outlives them. Physics runs on a pool of its own.
+		YellowstoneThreadPool threadPool{WORKER_THREAD_COUNT < 0 ? YellowstoneThreadPool::defaultWorkerCount() : static_cast<uint32_t>(WORKER_THREAD_COUNT)};
+		// Updates the registry and captures a render snapshot per frame on its own thread
+		// while the main thread records and presents the previous one
+		SimulationStage simulation{threadPool,
+			PHYSICS_WORKER_THREAD_COUNT < 0 ? YellowstoneThreadPool::defaultWorkerCount() : static_cast<uint32_t>(PHYSICS_WORKER_THREAD_COUNT),
+			PHYSICS_STEP_RATE, FRAME_QUEUE_DEPTH};
 	};
 }
\ No newline at end of file
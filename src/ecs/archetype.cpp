@@ -0,0 +1,56 @@
+#include "archetype.hpp"
+
+#include <atomic>
+#include <cassert>
+
+namespace yellowstone {
+
+	uint32_t allocateComponentTypeId() {
+		static std::atomic<uint32_t> nextId{0};
+		uint32_t id = nextId++;
+		assert(id < maxComponentTypes && "Too many component types for ComponentMask");
+		return id;
+	}
+
+	Archetype::Archetype(ComponentMask mask, const std::array<std::unique_ptr<ComponentColumn>, maxComponentTypes>& prototypes) : mask{mask} {
+		for (uint32_t id = 0; id < maxComponentTypes; id++) {
+			if (mask & (ComponentMask{1} << id)) {
+				assert(prototypes[id] != nullptr && "Component type was never registered");
+				columns[id] = prototypes[id]->createEmpty();
+			}
+		}
+	}
+
+	uint32_t Archetype::appendEntity(Entity entity) {
+		entities.push_back(entity);
+		return static_cast<uint32_t>(entities.size()) - 1;
+	}
+
+	uint32_t Archetype::moveFrom(Archetype& source, uint32_t row) {
+		ComponentMask shared = mask & source.mask;
+		for (uint32_t id = 0; id < maxComponentTypes; id++) {
+			if (shared & (ComponentMask{1} << id)) {
+				columns[id]->appendFrom(*source.columns[id], row);
+			}
+		}
+		return appendEntity(source.entities[row]);
+	}
+
+	Entity Archetype::removeRow(uint32_t row) {
+		for (uint32_t id = 0; id < maxComponentTypes; id++) {
+			if (columns[id] != nullptr) {
+				columns[id]->swapRemove(row);
+			}
+		}
+
+		uint32_t last = static_cast<uint32_t>(entities.size()) - 1;
+		Entity moved = nullEntity;
+		if (row != last) {
+			entities[row] = entities[last];
+			moved = entities[row];
+		}
+		entities.pop_back();
+		return moved;
+	}
+
+}
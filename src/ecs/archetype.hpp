@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../yellowstone_slot_map.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace yellowstone {
+
+	using Entity = SlotMapHandle;
+	constexpr Entity nullEntity = ~Entity{0};
+
+	// One bit per component type
+	using ComponentMask = uint64_t;
+	constexpr uint32_t maxComponentTypes = 64;
+
+	inline uint32_t componentCount(ComponentMask mask) {
+		uint32_t count = 0;
+		for (; mask != 0; mask &= mask - 1) count++;
+		return count;
+	}
+
+	uint32_t allocateComponentTypeId();
+
+	// Dense id per component type, assigned on first use
+	template <typename T>
+	uint32_t componentTypeId() {
+		static const uint32_t id = allocateComponentTypeId();
+		return id;
+	}
+
+	// Type-erased storage for one component type of one archetype
+	class ComponentColumn {
+	public:
+		virtual ~ComponentColumn() = default;
+		virtual std::unique_ptr<ComponentColumn> createEmpty() const = 0;
+		// Moves the element at 'row' of a column of the same type onto the end of this one
+		virtual void appendFrom(ComponentColumn& source, uint32_t row) = 0;
+		virtual void swapRemove(uint32_t row) = 0;
+	};
+
+	template <typename T>
+	class TypedColumn : public ComponentColumn {
+	public:
+		std::unique_ptr<ComponentColumn> createEmpty() const override {
+			return std::make_unique<TypedColumn<T>>();
+		}
+
+		void appendFrom(ComponentColumn& source, uint32_t row) override {
+			data.push_back(std::move(static_cast<TypedColumn<T>&>(source).data[row]));
+		}
+
+		void swapRemove(uint32_t row) override {
+			if (row + 1 != data.size()) {
+				data[row] = std::move(data.back());
+			}
+			data.pop_back();
+		}
+
+		std::vector<T> data;
+	};
+
+	// All entities that have exactly the same set of components. Each component type is a
+	// contiguous column, and row i of every column belongs to entities[i].
+	class Archetype {
+	public:
+		Archetype(ComponentMask mask, const std::array<std::unique_ptr<ComponentColumn>, maxComponentTypes>& prototypes);
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		ComponentMask getMask() const { return mask; }
+		uint32_t size() const { return static_cast<uint32_t>(entities.size()); }
+		const std::vector<Entity>& getEntities() const { return entities; }
+
+		template <typename T>
+		std::vector<T>& getColumn() {
+			return static_cast<TypedColumn<T>&>(*columns[componentTypeId<T>()]).data;
+		}
+
+		// Adds a row for 'entity'; the caller pushes one element onto every column
+		uint32_t appendEntity(Entity entity);
+		// Moves the components this archetype shares with 'source' from its 'row'; columns
+		// that 'source' doesn't have are left for the caller to fill
+		uint32_t moveFrom(Archetype& source, uint32_t row);
+		// Removes a row by moving the last one into it, and returns the entity that moved
+		// there, or nullEntity if 'row' was the last
+		Entity removeRow(uint32_t row);
+
+	private:
+		ComponentMask mask;
+		std::vector<Entity> entities;
+		std::array<std::unique_ptr<ComponentColumn>, maxComponentTypes> columns;
+	};
+
+}
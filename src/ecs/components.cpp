@@ -0,0 +1,74 @@
+#include "components.hpp"
+
+namespace yellowstone {
+    bool TransformComponent::updateMatrices() {
+        if (rotation != cachedRotation || orientation != cachedOrientation || scale != cachedScale) {
+            recomputeMatrices();
+            return true;
+        }
+        if (translation != cachedTranslation) {
+            modelMatrix[3] = glm::vec4{translation, 1.0f};
+            cachedTranslation = translation;
+            return true;
+        }
+        return false;
+    }
+
+    void TransformComponent::recomputeMatrices() {
+        // Columns of the rotation matrix
+        glm::vec3 axisX, axisY, axisZ;
+        if (orientation) {
+            const glm::quat& q = *orientation;
+            const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+            axisX = {1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)};
+            axisY = {2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)};
+            axisZ = {2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)};
+        } else {
+            const float c3 = glm::cos(rotation.z);
+            const float s3 = glm::sin(rotation.z);
+            const float c2 = glm::cos(rotation.x);
+            const float s2 = glm::sin(rotation.x);
+            const float c1 = glm::cos(rotation.y);
+            const float s1 = glm::sin(rotation.y);
+            axisX = {c1 * c3 + s1 * s2 * s3, c2 * s3, c1 * s2 * s3 - c3 * s1};
+            axisY = {c3 * s1 * s2 - c1 * s3, c2 * c3, c1 * c3 * s2 + s1 * s3};
+            axisZ = {c2 * s1, -s2, c1 * c2};
+        }
+        const glm::vec3 invScale = 1.0f / scale;
+
+        modelMatrix = glm::mat4{
+            glm::vec4{axisX * scale.x, 0.0f},
+            glm::vec4{axisY * scale.y, 0.0f},
+            glm::vec4{axisZ * scale.z, 0.0f},
+            glm::vec4{translation, 1.0f}};
+        normal = glm::mat3{axisX * invScale.x, axisY * invScale.y, axisZ * invScale.z};
+
+        cachedTranslation = translation;
+        cachedScale = scale;
+        cachedRotation = rotation;
+        cachedOrientation = orientation;
+    }
+
+    glm::quat eulerToQuaternion(const glm::vec3& rotation) {
+        // Product of the Y, X and Z half-angle rotations, in that order
+        const float cx = glm::cos(rotation.x * 0.5f), sx = glm::sin(rotation.x * 0.5f);
+        const float cy = glm::cos(rotation.y * 0.5f), sy = glm::sin(rotation.y * 0.5f);
+        const float cz = glm::cos(rotation.z * 0.5f), sz = glm::sin(rotation.z * 0.5f);
+        return glm::quat{
+            cx * cy * cz + sx * sy * sz,
+            sx * cy * cz + cx * sy * sz,
+            cx * sy * cz - sx * cy * sz,
+            cx * cy * sz - sx * sy * cz};
+    }
+
+    glm::vec3 quaternionToEuler(const glm::quat& q) {
+        // Read the angles back off the rotation matrix built in recomputeMatrices
+        const float sinX = glm::clamp(2.0f * (q.w * q.x - q.y * q.z), -1.0f, 1.0f);
+        return {
+            std::asin(sinX),
+            std::atan2(2.0f * (q.x * q.z + q.w * q.y), 1.0f - 2.0f * (q.x * q.x + q.y * q.y)),
+            std::atan2(2.0f * (q.x * q.y + q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z))};
+    }
+}
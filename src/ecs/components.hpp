@@ -0,0 +1,74 @@
+#pragma once
+
+#include "archetype.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <memory>
+#include <optional>
+
+namespace yellowstone {
+
+	// Only held by pointer here, so components (and physics) don't pull in Vulkan
+	class YellowstoneModel;
+
+	struct TransformComponent {
+		glm::vec3 translation{};
+		glm::vec3 scale{ 1.f, 1.f, 1.f };
+		// Tait-Bryan angles applied Y, X, Z
+		glm::vec3 rotation{};
+		// Unit quaternion that replaces 'rotation' when set. Matrices are then built without
+		// any trig, so prefer it for objects whose rotation changes every frame.
+		std::optional<glm::quat> orientation{};
+
+		// Model and normal matrices are cached and only rebuilt when the fields above changed
+		// since the last call. A change of translation alone just patches the last column.
+		const glm::mat4& mat4() { updateMatrices(); return modelMatrix; }
+		const glm::mat3& normalMatrix() { updateMatrices(); return normal; }
+		// Returns true if the cached matrices had to be updated
+		bool updateMatrices();
+
+	private:
+		void recomputeMatrices();
+
+		glm::mat4 modelMatrix{ 1.f };
+		glm::mat3 normal{ 1.f };
+		// Inputs the cached matrices were built from
+		glm::vec3 cachedTranslation{};
+		glm::vec3 cachedScale{ 1.f, 1.f, 1.f };
+		glm::vec3 cachedRotation{};
+		std::optional<glm::quat> cachedOrientation{};
+	};
+
+	// Conversions between TransformComponent::rotation and an orientation quaternion. Angles
+	// from quaternionToEuler are ambiguous when the X rotation is at +-pi/2.
+	glm::quat eulerToQuaternion(const glm::vec3& rotation);
+	glm::vec3 quaternionToEuler(const glm::quat& orientation);
+
+	struct PhysicsComponent {
+		glm::vec3 velocity{ 0.0f, 0.0f, 0.0f };
+		float mass = 1.0f;
+	};
+
+	// Tag for physics entities that never move; they collide but aren't simulated
+	struct StaticComponent {};
+
+	// Puts the entity in a transform hierarchy: its TransformComponent becomes relative to
+	// 'parent' and TransformHierarchySystem fills in the world matrices below. Roots of a
+	// hierarchy keep the default null parent. Only roots may have a PhysicsComponent, as
+	// physics works in world space.
+	struct HierarchyComponent {
+		Entity parent = nullEntity;
+		glm::mat4 worldMatrix{ 1.f };
+		glm::mat3 worldNormalMatrix{ 1.f };
+	};
+
+	struct MeshComponent {
+		std::shared_ptr<YellowstoneModel> model{};
+		glm::vec3 color{};
+	};
+}
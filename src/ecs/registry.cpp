@@ -0,0 +1,60 @@
+#include "registry.hpp"
+
+#include <stdexcept>
+
+namespace yellowstone {
+
+	YellowstoneRegistry::YellowstoneRegistry() {
+		// Archetype 0 holds entities without components
+		findOrCreateArchetype(0);
+	}
+
+	YellowstoneRegistry::EntityRecord& YellowstoneRegistry::getRecord(Entity entity) {
+		EntityRecord* record = records.get(entity);
+		if (record == nullptr) {
+			throw std::runtime_error("entity does not exist");
+		}
+		return *record;
+	}
+
+	void YellowstoneRegistry::destroy(Entity entity) {
+		EntityRecord* record = records.get(entity);
+		if (record == nullptr) {
+			return;
+		}
+
+		Entity moved = archetypes[record->archetype]->removeRow(record->row);
+		if (moved != nullEntity) {
+			records.get(moved)->row = record->row;
+		}
+		records.erase(entity);
+		version++;
+	}
+
+	uint32_t YellowstoneRegistry::findOrCreateArchetype(ComponentMask mask) {
+		auto it = archetypeLookup.find(mask);
+		if (it != archetypeLookup.end()) {
+			return it->second;
+		}
+
+		uint32_t index = static_cast<uint32_t>(archetypes.size());
+		archetypes.push_back(std::make_unique<Archetype>(mask, columnPrototypes));
+		archetypeLookup[mask] = index;
+		return index;
+	}
+
+	void YellowstoneRegistry::moveEntity(Entity entity, uint32_t target) {
+		EntityRecord& record = getRecord(entity);
+		Archetype& source = *archetypes[record.archetype];
+		uint32_t row = archetypes[target]->moveFrom(source, record.row);
+
+		Entity moved = source.removeRow(record.row);
+		if (moved != nullEntity) {
+			records.get(moved)->row = record.row;
+		}
+		record.archetype = target;
+		record.row = row;
+		version++;
+	}
+
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "archetype.hpp"
+
+#include <cassert>
+#include <unordered_map>
+
+namespace yellowstone {
+
+	// Component types an each() query must not have, e.g. Without<StaticComponent>{}
+	template <typename... Ts>
+	struct Without {};
+
+	// Archetype-based entity registry. Entities with the same set of components share an
+	// archetype, so a query only visits archetypes that match and walks their columns
+	// linearly, without checking components per entity. Adding or removing a component moves
+	// the entity to another archetype, which invalidates references to its components.
+	class YellowstoneRegistry {
+	public:
+		YellowstoneRegistry();
+		YellowstoneRegistry(const YellowstoneRegistry&) = delete;
+		YellowstoneRegistry& operator=(const YellowstoneRegistry&) = delete;
+
+		template <typename... Ts>
+		Entity create(Ts... components) {
+			(registerComponent<Ts>(), ...);
+			ComponentMask mask = maskOf<Ts...>();
+			assert(componentCount(mask) == sizeof...(Ts) && "Duplicate component type");
+
+			uint32_t archetypeIndex = findOrCreateArchetype(mask);
+			Archetype& archetype = *archetypes[archetypeIndex];
+			Entity entity = records.insert({archetypeIndex, 0});
+			records.get(entity)->row = archetype.appendEntity(entity);
+			(archetype.getColumn<Ts>().push_back(std::move(components)), ...);
+			version++;
+			return entity;
+		}
+
+		void destroy(Entity entity);
+		bool isAlive(Entity entity) const { return records.contains(entity); }
+
+		// Adds the component, or overwrites it if the entity already has one
+		template <typename T>
+		T& add(Entity entity, T component) {
+			registerComponent<T>();
+			EntityRecord& record = getRecord(entity);
+			Archetype& source = *archetypes[record.archetype];
+			ComponentMask bit = ComponentMask{1} << componentTypeId<T>();
+			if (source.getMask() & bit) {
+				T& existing = source.getColumn<T>()[record.row];
+				existing = std::move(component);
+				return existing;
+			}
+
+			uint32_t target = findOrCreateArchetype(source.getMask() | bit);
+			moveEntity(entity, target);
+			std::vector<T>& column = archetypes[target]->getColumn<T>();
+			column.push_back(std::move(component));
+			return column.back();
+		}
+
+		template <typename T>
+		void remove(Entity entity) {
+			EntityRecord& record = getRecord(entity);
+			ComponentMask mask = archetypes[record.archetype]->getMask();
+			ComponentMask bit = ComponentMask{1} << componentTypeId<T>();
+			if (mask & bit) {
+				moveEntity(entity, findOrCreateArchetype(mask & ~bit));
+			}
+		}
+
+		template <typename T>
+		bool has(Entity entity) const {
+			const EntityRecord* record = records.get(entity);
+			return record != nullptr && (archetypes[record->archetype]->getMask() & (ComponentMask{1} << componentTypeId<T>()));
+		}
+
+		// Null if the entity is gone or doesn't have the component
+		template <typename T>
+		T* get(Entity entity) {
+			const EntityRecord* record = records.get(entity);
+			if (record == nullptr) return nullptr;
+			Archetype& archetype = *archetypes[record->archetype];
+			if (!(archetype.getMask() & (ComponentMask{1} << componentTypeId<T>()))) return nullptr;
+			return &archetype.getColumn<T>()[record->row];
+		}
+
+		// Calls f(Entity, Ts&...) for every entity that has all of Ts and none of the excluded
+		// types. Structural changes (create, destroy, add, remove) are not allowed inside f.
+		template <typename... Ts, typename... Excluded, typename F>
+		void each(Without<Excluded...>, F&& f) {
+			eachChunk<Ts...>(Without<Excluded...>{}, [&](uint32_t count, const Entity* entities, Ts*... columns) {
+				for (uint32_t row = 0; row < count; row++) {
+					f(entities[row], columns[row]...);
+				}
+			});
+		}
+
+		template <typename... Ts, typename F>
+		void each(F&& f) {
+			each<Ts...>(Without<>{}, std::forward<F>(f));
+		}
+
+		// Calls f(count, entities, Ts*... columns) once per matching archetype, for systems
+		// that process whole columns at a time
+		template <typename... Ts, typename... Excluded, typename F>
+		void eachChunk(Without<Excluded...>, F&& f) {
+			ComponentMask include = maskOf<Ts...>();
+			ComponentMask exclude = maskOf<Excluded...>();
+			for (auto& archetype : archetypes) {
+				if ((archetype->getMask() & include) != include || (archetype->getMask() & exclude) != 0 || archetype->size() == 0) {
+					continue;
+				}
+				f(archetype->size(), archetype->getEntities().data(), archetype->getColumn<Ts>().data()...);
+			}
+		}
+
+		size_t size() const { return records.size(); }
+		size_t getArchetypeCount() const { return archetypes.size(); }
+		// Changes on every create, destroy, add or remove of a component
+		uint64_t getVersion() const { return version; }
+
+	private:
+		struct EntityRecord {
+			uint32_t archetype;
+			uint32_t row;
+		};
+
+		template <typename... Ts>
+		static ComponentMask maskOf() {
+			return (ComponentMask{0} | ... | (ComponentMask{1} << componentTypeId<Ts>()));
+		}
+
+		template <typename T>
+		void registerComponent() {
+			auto& prototype = columnPrototypes[componentTypeId<T>()];
+			if (prototype == nullptr) {
+				prototype = std::make_unique<TypedColumn<T>>();
+			}
+		}
+
+		EntityRecord& getRecord(Entity entity);
+		uint32_t findOrCreateArchetype(ComponentMask mask);
+		// Moves the entity's shared components into 'target'. Columns only 'target' has are
+		// left one short for the caller to push onto.
+		void moveEntity(Entity entity, uint32_t target);
+
+		YellowstoneSlotMap<EntityRecord> records;
+		std::vector<std::unique_ptr<Archetype>> archetypes;
+		std::unordered_map<ComponentMask, uint32_t> archetypeLookup;
+		// An empty column per registered component type, cloned for new archetypes
+		std::array<std::unique_ptr<ComponentColumn>, maxComponentTypes> columnPrototypes;
+		uint64_t version = 0;
+	};
+
+}
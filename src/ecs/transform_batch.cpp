@@ -0,0 +1,253 @@
+#include "transform_batch.hpp"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define YELLOWSTONE_TRANSFORM_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YELLOWSTONE_TRANSFORM_SSE2
+#endif
+
+namespace yellowstone {
+
+	namespace {
+
+		// Same math as TransformComponent, for the remainder and for targets without SIMD
+		void computeScalar(const TransformArrays& t, size_t begin, size_t end, TransformMatrices* output) {
+			for (size_t i = begin; i < end; i++) {
+				const float c3 = std::cos(t.rotationZ[i]);
+				const float s3 = std::sin(t.rotationZ[i]);
+				const float c2 = std::cos(t.rotationX[i]);
+				const float s2 = std::sin(t.rotationX[i]);
+				const float c1 = std::cos(t.rotationY[i]);
+				const float s1 = std::sin(t.rotationY[i]);
+				const glm::vec3 scale{t.scaleX[i], t.scaleY[i], t.scaleZ[i]};
+				const glm::vec3 invScale = 1.0f / scale;
+
+				const glm::vec3 axisX{c1 * c3 + s1 * s2 * s3, c2 * s3, c1 * s2 * s3 - c3 * s1};
+				const glm::vec3 axisY{c3 * s1 * s2 - c1 * s3, c2 * c3, c1 * c3 * s2 + s1 * s3};
+				const glm::vec3 axisZ{c2 * s1, -s2, c1 * c2};
+
+				TransformMatrices& out = output[i];
+				out.modelMatrix[0] = glm::vec4{axisX * scale.x, 0.0f};
+				out.modelMatrix[1] = glm::vec4{axisY * scale.y, 0.0f};
+				out.modelMatrix[2] = glm::vec4{axisZ * scale.z, 0.0f};
+				out.modelMatrix[3] = glm::vec4{t.translationX[i], t.translationY[i], t.translationZ[i], 1.0f};
+				out.normalMatrix[0] = glm::vec4{axisX * invScale.x, 0.0f};
+				out.normalMatrix[1] = glm::vec4{axisY * invScale.y, 0.0f};
+				out.normalMatrix[2] = glm::vec4{axisZ * invScale.z, 0.0f};
+				out.normalMatrix[3] = glm::vec4{0.0f, 0.0f, 0.0f, 1.0f};
+			}
+		}
+
+#if defined(YELLOWSTONE_TRANSFORM_AVX2)
+
+		struct Lanes {
+			static constexpr size_t width = 8;
+			using Float = __m256;
+			using Int = __m256i;
+
+			static Float load(const float* p) { return _mm256_loadu_ps(p); }
+			static Float set(float v) { return _mm256_set1_ps(v); }
+			static Int seti(int v) { return _mm256_set1_epi32(v); }
+			static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+			static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+			static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+			static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+			static Float andf(Float a, Float b) { return _mm256_and_ps(a, b); }
+			static Float andnotf(Float a, Float b) { return _mm256_andnot_ps(a, b); }
+			static Float xorf(Float a, Float b) { return _mm256_xor_ps(a, b); }
+			static Int addi(Int a, Int b) { return _mm256_add_epi32(a, b); }
+			static Int subi(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+			static Int andi(Int a, Int b) { return _mm256_and_si256(a, b); }
+			static Int andnoti(Int a, Int b) { return _mm256_andnot_si256(a, b); }
+			static Int cmpeqi(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+			static Int shiftLeft29(Int a) { return _mm256_slli_epi32(a, 29); }
+			static Int truncate(Float a) { return _mm256_cvttps_epi32(a); }
+			static Float toFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+			static Float asFloat(Int a) { return _mm256_castsi256_ps(a); }
+
+			// Writes one matrix column (x, y, z, w lanes) for each of the 8 objects
+			static void storeColumn(Float x, Float y, Float z, Float w, float* base, size_t stride) {
+				__m128 lowX = _mm256_castps256_ps128(x), highX = _mm256_extractf128_ps(x, 1);
+				__m128 lowY = _mm256_castps256_ps128(y), highY = _mm256_extractf128_ps(y, 1);
+				__m128 lowZ = _mm256_castps256_ps128(z), highZ = _mm256_extractf128_ps(z, 1);
+				__m128 lowW = _mm256_castps256_ps128(w), highW = _mm256_extractf128_ps(w, 1);
+				_MM_TRANSPOSE4_PS(lowX, lowY, lowZ, lowW);
+				_MM_TRANSPOSE4_PS(highX, highY, highZ, highW);
+				_mm_storeu_ps(base, lowX);
+				_mm_storeu_ps(base + stride, lowY);
+				_mm_storeu_ps(base + stride * 2, lowZ);
+				_mm_storeu_ps(base + stride * 3, lowW);
+				_mm_storeu_ps(base + stride * 4, highX);
+				_mm_storeu_ps(base + stride * 5, highY);
+				_mm_storeu_ps(base + stride * 6, highZ);
+				_mm_storeu_ps(base + stride * 7, highW);
+			}
+		};
+
+#elif defined(YELLOWSTONE_TRANSFORM_SSE2)
+
+		struct Lanes {
+			static constexpr size_t width = 4;
+			using Float = __m128;
+			using Int = __m128i;
+
+			static Float load(const float* p) { return _mm_loadu_ps(p); }
+			static Float set(float v) { return _mm_set1_ps(v); }
+			static Int seti(int v) { return _mm_set1_epi32(v); }
+			static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+			static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+			static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+			static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+			static Float andf(Float a, Float b) { return _mm_and_ps(a, b); }
+			static Float andnotf(Float a, Float b) { return _mm_andnot_ps(a, b); }
+			static Float xorf(Float a, Float b) { return _mm_xor_ps(a, b); }
+			static Int addi(Int a, Int b) { return _mm_add_epi32(a, b); }
+			static Int subi(Int a, Int b) { return _mm_sub_epi32(a, b); }
+			static Int andi(Int a, Int b) { return _mm_and_si128(a, b); }
+			static Int andnoti(Int a, Int b) { return _mm_andnot_si128(a, b); }
+			static Int cmpeqi(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+			static Int shiftLeft29(Int a) { return _mm_slli_epi32(a, 29); }
+			static Int truncate(Float a) { return _mm_cvttps_epi32(a); }
+			static Float toFloat(Int a) { return _mm_cvtepi32_ps(a); }
+			static Float asFloat(Int a) { return _mm_castsi128_ps(a); }
+
+			// Writes one matrix column (x, y, z, w lanes) for each of the 4 objects
+			static void storeColumn(Float x, Float y, Float z, Float w, float* base, size_t stride) {
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(base, x);
+				_mm_storeu_ps(base + stride, y);
+				_mm_storeu_ps(base + stride * 2, z);
+				_mm_storeu_ps(base + stride * 3, w);
+			}
+		};
+
+#endif
+
+#if defined(YELLOWSTONE_TRANSFORM_AVX2) || defined(YELLOWSTONE_TRANSFORM_SSE2)
+
+		using Float = Lanes::Float;
+		using Int = Lanes::Int;
+
+		// Cephes-style sincos: reduce to [-pi/4, pi/4] by multiples of pi/2, evaluate both
+		// minimax polynomials and pick/negate per quadrant. Accurate to a couple of ulp for the
+		// angle ranges transforms use.
+		void sincos(Float x, Float& sinOut, Float& cosOut) {
+			const Float signMask = Lanes::asFloat(Lanes::seti(static_cast<int>(0x80000000u)));
+			Float sinSign = Lanes::andf(x, signMask);
+			x = Lanes::andnotf(signMask, x);
+
+			// Octant, rounded up to even so the remainder is centred on zero
+			Int octant = Lanes::truncate(Lanes::mul(x, Lanes::set(1.27323954473516f)));
+			octant = Lanes::andi(Lanes::addi(octant, Lanes::seti(1)), Lanes::seti(~1));
+			Float y = Lanes::toFloat(octant);
+
+			Float swapSinSign = Lanes::asFloat(Lanes::shiftLeft29(Lanes::andi(octant, Lanes::seti(4))));
+			Float usePolySin = Lanes::asFloat(Lanes::cmpeqi(Lanes::andi(octant, Lanes::seti(2)), Lanes::seti(0)));
+			Float cosSign = Lanes::asFloat(Lanes::shiftLeft29(Lanes::andnoti(Lanes::subi(octant, Lanes::seti(2)), Lanes::seti(4))));
+			sinSign = Lanes::xorf(sinSign, swapSinSign);
+
+			// x - y * pi/4 in three steps to keep precision
+			x = Lanes::sub(x, Lanes::mul(y, Lanes::set(0.78515625f)));
+			x = Lanes::sub(x, Lanes::mul(y, Lanes::set(2.4187564849853515625e-4f)));
+			x = Lanes::sub(x, Lanes::mul(y, Lanes::set(3.77489497744594108e-8f)));
+			Float z = Lanes::mul(x, x);
+
+			Float cosPoly = Lanes::set(2.443315711809948e-5f);
+			cosPoly = Lanes::add(Lanes::mul(cosPoly, z), Lanes::set(-1.388731625493765e-3f));
+			cosPoly = Lanes::add(Lanes::mul(cosPoly, z), Lanes::set(4.166664568298827e-2f));
+			cosPoly = Lanes::mul(Lanes::mul(cosPoly, z), z);
+			cosPoly = Lanes::sub(cosPoly, Lanes::mul(z, Lanes::set(0.5f)));
+			cosPoly = Lanes::add(cosPoly, Lanes::set(1.0f));
+
+			Float sinPoly = Lanes::set(-1.9515295891e-4f);
+			sinPoly = Lanes::add(Lanes::mul(sinPoly, z), Lanes::set(8.3321608736e-3f));
+			sinPoly = Lanes::add(Lanes::mul(sinPoly, z), Lanes::set(-1.6666654611e-1f));
+			sinPoly = Lanes::add(Lanes::mul(Lanes::mul(sinPoly, z), x), x);
+
+			Float sinValue = Lanes::add(Lanes::andf(usePolySin, sinPoly), Lanes::andnotf(usePolySin, cosPoly));
+			Float cosValue = Lanes::add(Lanes::andnotf(usePolySin, sinPoly), Lanes::andf(usePolySin, cosPoly));
+			sinOut = Lanes::xorf(sinValue, sinSign);
+			cosOut = Lanes::xorf(cosValue, cosSign);
+		}
+
+		size_t computeSimd(const TransformArrays& t, size_t count, TransformMatrices* output) {
+			const Float zero = Lanes::set(0.0f);
+			const Float one = Lanes::set(1.0f);
+			const size_t stride = sizeof(TransformMatrices) / sizeof(float);
+
+			size_t i = 0;
+			for (; i + Lanes::width <= count; i += Lanes::width) {
+				Float s1, c1, s2, c2, s3, c3;
+				sincos(Lanes::load(t.rotationY + i), s1, c1);
+				sincos(Lanes::load(t.rotationX + i), s2, c2);
+				sincos(Lanes::load(t.rotationZ + i), s3, c3);
+
+				Float s1s2 = Lanes::mul(s1, s2);
+				Float c1s2 = Lanes::mul(c1, s2);
+				Float axisX[3] = {
+					Lanes::add(Lanes::mul(c1, c3), Lanes::mul(s1s2, s3)),
+					Lanes::mul(c2, s3),
+					Lanes::sub(Lanes::mul(c1s2, s3), Lanes::mul(c3, s1)),
+				};
+				Float axisY[3] = {
+					Lanes::sub(Lanes::mul(c3, s1s2), Lanes::mul(c1, s3)),
+					Lanes::mul(c2, c3),
+					Lanes::add(Lanes::mul(c1s2, c3), Lanes::mul(s1, s3)),
+				};
+				Float axisZ[3] = {
+					Lanes::mul(c2, s1),
+					Lanes::sub(zero, s2),
+					Lanes::mul(c1, c2),
+				};
+
+				Float scaleX = Lanes::load(t.scaleX + i);
+				Float scaleY = Lanes::load(t.scaleY + i);
+				Float scaleZ = Lanes::load(t.scaleZ + i);
+				Float invScaleX = Lanes::div(one, scaleX);
+				Float invScaleY = Lanes::div(one, scaleY);
+				Float invScaleZ = Lanes::div(one, scaleZ);
+
+				float* model = &output[i].modelMatrix[0][0];
+				float* normal = &output[i].normalMatrix[0][0];
+				Lanes::storeColumn(Lanes::mul(axisX[0], scaleX), Lanes::mul(axisX[1], scaleX), Lanes::mul(axisX[2], scaleX), zero, model, stride);
+				Lanes::storeColumn(Lanes::mul(axisY[0], scaleY), Lanes::mul(axisY[1], scaleY), Lanes::mul(axisY[2], scaleY), zero, model + 4, stride);
+				Lanes::storeColumn(Lanes::mul(axisZ[0], scaleZ), Lanes::mul(axisZ[1], scaleZ), Lanes::mul(axisZ[2], scaleZ), zero, model + 8, stride);
+				Lanes::storeColumn(Lanes::load(t.translationX + i), Lanes::load(t.translationY + i), Lanes::load(t.translationZ + i), one, model + 12, stride);
+				Lanes::storeColumn(Lanes::mul(axisX[0], invScaleX), Lanes::mul(axisX[1], invScaleX), Lanes::mul(axisX[2], invScaleX), zero, normal, stride);
+				Lanes::storeColumn(Lanes::mul(axisY[0], invScaleY), Lanes::mul(axisY[1], invScaleY), Lanes::mul(axisY[2], invScaleY), zero, normal + 4, stride);
+				Lanes::storeColumn(Lanes::mul(axisZ[0], invScaleZ), Lanes::mul(axisZ[1], invScaleZ), Lanes::mul(axisZ[2], invScaleZ), zero, normal + 8, stride);
+				Lanes::storeColumn(zero, zero, zero, one, normal + 12, stride);
+			}
+			return i;
+		}
+
+#else
+
+		size_t computeSimd(const TransformArrays&, size_t, TransformMatrices*) {
+			return 0;
+		}
+
+#endif
+
+	}
+
+	void computeTransformMatrices(const TransformArrays& transforms, size_t count, TransformMatrices* output) {
+		size_t done = computeSimd(transforms, count, output);
+		computeScalar(transforms, done, count, output);
+	}
+
+	const char* getTransformBatchBackendName() {
+#if defined(YELLOWSTONE_TRANSFORM_AVX2)
+		return "avx2";
+#elif defined(YELLOWSTONE_TRANSFORM_SSE2)
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+}
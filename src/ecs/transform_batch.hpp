@@ -0,0 +1,40 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+namespace yellowstone {
+
+	// Structure-of-arrays input, one float per transform in each array
+	struct TransformArrays {
+		const float* translationX;
+		const float* translationY;
+		const float* translationZ;
+		const float* rotationX;
+		const float* rotationY;
+		const float* rotationZ;
+		const float* scaleX;
+		const float* scaleY;
+		const float* scaleZ;
+	};
+
+	// Per-object matrices in the layout the shaders read them in. The normal matrix is stored
+	// as a mat4 so an array of these can be uploaded to a buffer as is.
+	struct TransformMatrices {
+		glm::mat4 modelMatrix;
+		glm::mat4 normalMatrix;
+	};
+	static_assert(sizeof(TransformMatrices) == 32 * sizeof(float), "TransformMatrices must be tightly packed");
+
+	// Batch version of TransformComponent::mat4() and normalMatrix(). Computes sin/cos of the
+	// rotations with a vectorized polynomial, 8 transforms per step with AVX2 or 4 with SSE2,
+	// and writes the matrices straight to 'output'. The remainder goes through the same scalar
+	// math as TransformComponent.
+	void computeTransformMatrices(const TransformArrays& transforms, size_t count, TransformMatrices* output);
+
+	const char* getTransformBatchBackendName();
+
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "yellowstone_game_object.hpp"
+#include "ecs/components.hpp"
 #include "yellowstone_window.hpp"
 
 namespace yellowstone {
@@ -19,7 +19,7 @@ namespace yellowstone {
             int lookDown = GLFW_KEY_DOWN;
         };
 
-        void moveInPlaneXZ(GLFWwindow* window, float dt, YellowstoneGameObject& gameObject);
+        void moveInPlaneXZ(GLFWwindow* window, float dt, TransformComponent& transform);
 
         KeyMappings keys{};
         float moveSpeed{3.0f};
@@ -0,0 +1,60 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace yellowstone {
+
+	struct AABB {
+		glm::vec3 min{};
+		glm::vec3 max{};
+
+		bool overlaps(const AABB& other) const {
+			return (min.x <= other.max.x && max.x >= other.min.x) &&
+			       (min.y <= other.max.y && max.y >= other.min.y) &&
+			       (min.z <= other.max.z && max.z >= other.min.z);
+		}
+
+		bool contains(const AABB& other) const {
+			return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+			       max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+		}
+
+		float surfaceArea() const {
+			glm::vec3 d = max - min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		AABB expanded(float margin) const {
+			return {min - glm::vec3(margin), max + glm::vec3(margin)};
+		}
+
+		static AABB merge(const AABB& a, const AABB& b) {
+			return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+		}
+
+		// Slab test. inverseDirection is 1 / direction per component; returns the entry
+		// distance through 'distance' when the ray hits the box within maxDistance
+		bool raycast(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance) const {
+			float tMin = 0.0f;
+			float tMax = maxDistance;
+			for (int axis = 0; axis < 3; axis++) {
+				float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+				float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+				tMin = std::max(tMin, std::min(t1, t2));
+				tMax = std::min(tMax, std::max(t1, t2));
+			}
+			distance = tMin;
+			return tMin <= tMax;
+		}
+	};
+
+	// Candidate pair of body indices produced by a broadphase, always with first < second
+	using BodyPair = std::pair<uint32_t, uint32_t>;
+
+}
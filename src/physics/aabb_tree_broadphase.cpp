@@ -0,0 +1,60 @@
+#include "aabb_tree_broadphase.hpp"
+
+namespace yellowstone {
+
+	void AABBTreeBroadphase::reset() {
+		tree.clear();
+		proxies.clear();
+		reinsertedBodies.clear();
+		reinserted.clear();
+		overlappingPairs.clear();
+	}
+
+	void AABBTreeBroadphase::update(const std::vector<AABB>& bounds, const std::vector<uint32_t>& movedBodies) {
+		if (bounds.size() != proxies.size()) {
+			reset();
+			proxies.resize(bounds.size());
+			reinserted.assign(bounds.size(), 1);
+			for (uint32_t i = 0; i < bounds.size(); i++) {
+				proxies[i] = tree.createProxy(bounds[i], i);
+				reinsertedBodies.push_back(i);
+			}
+			return;
+		}
+
+		for (uint32_t i : movedBodies) {
+			if (tree.moveProxy(proxies[i], bounds[i]) && !reinserted[i]) {
+				reinserted[i] = 1;
+				reinsertedBodies.push_back(i);
+			}
+		}
+	}
+
+	void AABBTreeBroadphase::findPairs(std::vector<BodyPair>& pairs) {
+		if (!reinsertedBodies.empty()) {
+			// Only pairs with a reinserted body can have stopped overlapping
+			overlappingPairs.removeIf([&](const BodyPair& pair) {
+				if (!reinserted[pair.first] && !reinserted[pair.second]) return false;
+				return !tree.getFatAABB(proxies[pair.first]).overlaps(tree.getFatAABB(proxies[pair.second]));
+			});
+
+			for (uint32_t body : reinsertedBodies) {
+				tree.query(tree.getFatAABB(proxies[body]), [&](uint32_t other) {
+					if (other != body) {
+						overlappingPairs.add(body, other);
+					}
+					return true;
+				});
+			}
+
+			for (uint32_t body : reinsertedBodies) {
+				reinserted[body] = 0;
+			}
+			reinsertedBodies.clear();
+		}
+
+		const auto& current = overlappingPairs.getPairs();
+		pairs.insert(pairs.end(), current.begin(), current.end());
+	}
+
+}
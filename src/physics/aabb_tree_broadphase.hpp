@@ -0,0 +1,36 @@
+#pragma once
+
+#include "broadphase.hpp"
+#include "dynamic_aabb_tree.hpp"
+#include "pair_set.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	// Broadphase on top of DynamicAABBTree. Bodies whose tight box stays inside their fat box
+	// are left alone; only reinserted bodies query the tree for new pairs, and pairs whose
+	// fat boxes stop overlapping are dropped. Reported pairs are fat-box overlaps, so the
+	// narrowphase still has to test the tight boxes.
+	class AABBTreeBroadphase : public Broadphase {
+	public:
+		explicit AABBTreeBroadphase(float fatMargin = 0.1f) : tree{fatMargin} {}
+
+		void reset() override;
+		void update(const std::vector<AABB>& bounds, const std::vector<uint32_t>& movedBodies) override;
+		void findPairs(std::vector<BodyPair>& pairs) override;
+
+		void setFatMargin(float margin) { tree.setFatMargin(margin); }
+		const DynamicAABBTree& getTree() const { return tree; }
+		size_t getReinsertedCount() const { return reinsertedBodies.size(); }
+
+	private:
+		DynamicAABBTree tree;
+		std::vector<int32_t> proxies;
+		std::vector<uint32_t> reinsertedBodies;
+		std::vector<uint8_t> reinserted;
+		PairSet overlappingPairs;
+	};
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "aabb.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	// Common interface for PhysicsSystem broadphases. Bodies are identified by their index
+	// into the bounds array, which must stay stable between calls until reset() is called.
+	class Broadphase {
+	public:
+		virtual ~Broadphase() = default;
+
+		virtual void reset() = 0;
+		// 'bounds' holds every body; only the bodies in 'movedBodies' changed since the last
+		// update. A change in body count always rebuilds.
+		virtual void update(const std::vector<AABB>& bounds, const std::vector<uint32_t>& movedBodies) = 0;
+		virtual void findPairs(std::vector<BodyPair>& pairs) = 0;
+	};
+
+	enum class BroadphaseType {
+		SpatialHash,
+		SweepAndPrune,
+		AABBTree,
+	};
+
+}
@@ -0,0 +1,83 @@
+#include "contact_islands.hpp"
+
+#include <utility>
+
+namespace yellowstone {
+
+	uint32_t ContactIslands::find(uint32_t body) {
+		// Path halving
+		while (parent[body] != body) {
+			parent[body] = parent[parent[body]];
+			body = parent[body];
+		}
+		return body;
+	}
+
+	void ContactIslands::unite(uint32_t a, uint32_t b) {
+		a = find(a);
+		b = find(b);
+		if (a == b) {
+			return;
+		}
+		// Union by size, smaller set under the larger one
+		if (setSize[a] < setSize[b]) {
+			std::swap(a, b);
+		}
+		parent[b] = a;
+		setSize[a] += setSize[b];
+	}
+
+	void ContactIslands::build(const PhysicsWorld& world, const std::vector<BodyPair>& contacts) {
+		if (parent.size() < world.size()) {
+			parent.resize(world.size());
+			setSize.resize(world.size());
+			islandOfRoot.resize(world.size());
+		}
+
+		// Only awake bodies take part, so a settled scene costs nothing here
+		uint32_t awakeCount = world.getAwakeCount();
+		for (uint32_t slot = 0; slot < awakeCount; slot++) {
+			uint32_t body = world.bodies[slot];
+			parent[body] = body;
+			setSize[body] = 1;
+		}
+
+		for (const auto& contact : contacts) {
+			if (contact.second != PhysicsWorld::groundBody && world.isAwake(contact.first) && world.isAwake(contact.second)) {
+				unite(contact.first, contact.second);
+			}
+		}
+
+		islands.clear();
+		for (uint32_t slot = 0; slot < awakeCount; slot++) {
+			uint32_t body = world.bodies[slot];
+			if (find(body) == body) {
+				islandOfRoot[body] = static_cast<uint32_t>(islands.size());
+				islands.push_back({0, 0, setSize[body], 0.0f, 0.0f, 0.0f, 0});
+			}
+		}
+
+		// Counting sort of contacts by island. Ground contacts always have an awake first body.
+		contactIsland.resize(contacts.size());
+		for (uint32_t c = 0; c < contacts.size(); c++) {
+			uint32_t body = world.isAwake(contacts[c].first) ? contacts[c].first : contacts[c].second;
+			uint32_t island = islandOfRoot[find(body)];
+			contactIsland[c] = island;
+			islands[island].contactCount++;
+		}
+
+		islandCursor.resize(islands.size());
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < islands.size(); i++) {
+			islands[i].contactBegin = offset;
+			islandCursor[i] = offset;
+			offset += islands[i].contactCount;
+		}
+
+		islandContacts.resize(contacts.size());
+		for (uint32_t c = 0; c < contacts.size(); c++) {
+			islandContacts[islandCursor[contactIsland[c]]++] = contacts[c];
+		}
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "physics_world.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	struct Island {
+		uint32_t contactBegin;
+		uint32_t contactCount;
+		uint32_t bodyCount;
+		float solveMilliseconds;
+		// Solver impulse change in the first and last iteration
+		float initialResidual;
+		float finalResidual;
+		uint32_t warmStartedContacts;
+	};
+
+	// Groups awake bodies into islands with a union-find over their contacts. Sleeping
+	// bodies and the ground act as immovable and never join two islands. Contacts are reordered so each
+	// island's contacts are contiguous, keeping their original relative order.
+	class ContactIslands {
+	public:
+		void build(const PhysicsWorld& world, const std::vector<BodyPair>& contacts);
+
+		const std::vector<Island>& getIslands() const { return islands; }
+		std::vector<Island>& getIslands() { return islands; }
+		const std::vector<BodyPair>& getContacts() const { return islandContacts; }
+		// Island of an awake body, valid until the next build
+		uint32_t getIsland(uint32_t body) { return islandOfRoot[find(body)]; }
+
+	private:
+		uint32_t find(uint32_t body);
+		void unite(uint32_t a, uint32_t b);
+
+		std::vector<uint32_t> parent;
+		std::vector<uint32_t> setSize;
+		std::vector<uint32_t> islandOfRoot;
+
+		std::vector<Island> islands;
+		std::vector<uint32_t> contactIsland;
+		std::vector<uint32_t> islandCursor;
+		std::vector<BodyPair> islandContacts;
+	};
+
+}
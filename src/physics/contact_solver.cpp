@@ -0,0 +1,175 @@
+#include "contact_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace yellowstone {
+
+	namespace {
+
+		glm::vec3 getBodyVelocity(const PhysicsWorld& world, uint32_t body) {
+			return body == PhysicsWorld::groundBody ? glm::vec3{0.0f} : world.getVelocity(world.getSlot(body));
+		}
+
+		void addBodyVelocity(PhysicsWorld& world, uint32_t body, const glm::vec3& change) {
+			uint32_t slot = world.getSlot(body);
+			world.setVelocity(slot, world.getVelocity(slot) + change);
+		}
+
+	}
+
+	void ContactSolver::beginStep(size_t contactCount) {
+		constraints.resize(contactCount);
+	}
+
+	void ContactSolver::clearCache() {
+		cache.clear();
+		nextCache.clear();
+	}
+
+	const ContactSolver::CachedImpulse* ContactSolver::findCached(uint64_t key) const {
+		auto it = std::lower_bound(cache.begin(), cache.end(), key, [](const CachedImpulse& cached, uint64_t k) {
+			return cached.key < k;
+		});
+		return it != cache.end() && it->key == key ? &*it : nullptr;
+	}
+
+	ContactConstraint ContactSolver::prepare(const PhysicsWorld& world, const BodyPair& contact, float deltaTime) const {
+		ContactConstraint c{};
+		c.body1 = contact.first;
+		c.body2 = contact.second;
+		uint32_t slot1 = world.getSlot(c.body1);
+		AABB box1 = world.getBounds(slot1);
+		bool ground = c.body2 == PhysicsWorld::groundBody;
+
+		// Sleeping bodies and the ground act as immovable
+		c.inverseMass1 = world.isAwake(c.body1) ? world.inverseMass[slot1] : 0.0f;
+		c.inverseMass2 = !ground && world.isAwake(c.body2) ? world.inverseMass[world.getSlot(c.body2)] : 0.0f;
+		float inverseMassSum = c.inverseMass1 + c.inverseMass2;
+		c.effectiveMass = inverseMassSum > 0.0f ? 1.0f / inverseMassSum : 0.0f;
+
+		int axis = 1;
+		float penetration;
+		c.normal = glm::vec3{0.0f};
+		if (ground) {
+			// The ground is below every body, which in Y-down is +Y
+			penetration = box1.max.y - groundY;
+			c.normal.y = 1.0f;
+		} else {
+			// Separate along the axis of least penetration
+			uint32_t slot2 = world.getSlot(c.body2);
+			AABB box2 = world.getBounds(slot2);
+			glm::vec3 overlap = glm::min(box1.max, box2.max) - glm::max(box1.min, box2.min);
+			glm::vec3 offset = world.getPosition(slot2) - world.getPosition(slot1);
+			axis = 0;
+			if (overlap.y < overlap[axis]) axis = 1;
+			if (overlap.z < overlap[axis]) axis = 2;
+			penetration = overlap[axis];
+			c.normal[axis] = offset[axis] < 0.0f ? -1.0f : 1.0f;
+		}
+		c.tangent1 = glm::vec3{0.0f};
+		c.tangent1[(axis + 1) % 3] = 1.0f;
+		c.tangent2 = glm::vec3{0.0f};
+		c.tangent2[(axis + 2) % 3] = 1.0f;
+
+		// Baumgarte stabilisation pushes overlapping bodies apart, restitution adds bounce
+		// for contacts that hit hard enough
+		glm::vec3 relativeVelocity = getBodyVelocity(world, c.body2) - world.getVelocity(slot1);
+		float closingVelocity = glm::dot(relativeVelocity, c.normal);
+		c.velocityBias = baumgarte / deltaTime * std::max(penetration - penetrationSlop, 0.0f);
+		if (closingVelocity < -restitutionThreshold) {
+			c.velocityBias = std::max(c.velocityBias, -restitution * closingVelocity);
+		}
+
+		// Warm start from the previous step if the contact kept its normal
+		if (const CachedImpulse* cached = findCached(pairKey(c.body1, c.body2))) {
+			if (glm::dot(cached->normal, c.normal) > 0.99f) {
+				c.normalImpulse = cached->normalImpulse;
+				c.tangentImpulse1 = cached->tangentImpulse1;
+				c.tangentImpulse2 = cached->tangentImpulse2;
+			}
+		}
+		return c;
+	}
+
+	float ContactSolver::applyImpulses(PhysicsWorld& world, ContactConstraint& c) const {
+		glm::vec3 velocity1 = getBodyVelocity(world, c.body1);
+		glm::vec3 velocity2 = getBodyVelocity(world, c.body2);
+
+		// Normal impulse, clamped so the accumulated impulse never pulls bodies together
+		glm::vec3 relativeVelocity = velocity2 - velocity1;
+		float lambda = -c.effectiveMass * (glm::dot(relativeVelocity, c.normal) - c.velocityBias);
+		float previous = c.normalImpulse;
+		c.normalImpulse = std::max(previous + lambda, 0.0f);
+		float normalDelta = c.normalImpulse - previous;
+		glm::vec3 impulse = c.normal * normalDelta;
+		velocity1 -= impulse * c.inverseMass1;
+		velocity2 += impulse * c.inverseMass2;
+
+		// Friction, bounded by the current normal impulse
+		float maxFriction = friction * c.normalImpulse;
+		float residual = std::abs(normalDelta);
+		float* tangentImpulses[2] = {&c.tangentImpulse1, &c.tangentImpulse2};
+		const glm::vec3* tangents[2] = {&c.tangent1, &c.tangent2};
+		for (int t = 0; t < 2; t++) {
+			relativeVelocity = velocity2 - velocity1;
+			float tangentLambda = -c.effectiveMass * glm::dot(relativeVelocity, *tangents[t]);
+			float previousTangent = *tangentImpulses[t];
+			*tangentImpulses[t] = std::max(-maxFriction, std::min(previousTangent + tangentLambda, maxFriction));
+			float tangentDelta = *tangentImpulses[t] - previousTangent;
+			glm::vec3 tangentImpulse = *tangents[t] * tangentDelta;
+			velocity1 -= tangentImpulse * c.inverseMass1;
+			velocity2 += tangentImpulse * c.inverseMass2;
+			residual += std::abs(tangentDelta);
+		}
+
+		// Never write sleeping bodies, other islands may be reading them
+		if (c.inverseMass1 > 0.0f) world.setVelocity(world.getSlot(c.body1), velocity1);
+		if (c.inverseMass2 > 0.0f) world.setVelocity(world.getSlot(c.body2), velocity2);
+		return residual;
+	}
+
+	SolverResidual ContactSolver::solve(PhysicsWorld& world, const std::vector<BodyPair>& contacts, uint32_t begin, uint32_t count, float deltaTime) {
+		SolverResidual residual{0.0f, 0.0f, 0};
+		uint32_t end = begin + count;
+
+		// Every constraint is prepared before any is warm started, so the closing velocities
+		// that decide restitution are the ones the bodies arrived with
+		for (uint32_t i = begin; i < end; i++) {
+			constraints[i] = prepare(world, contacts[i], deltaTime);
+		}
+		for (uint32_t i = begin; i < end; i++) {
+			const ContactConstraint& c = constraints[i];
+			if (c.normalImpulse == 0.0f && c.tangentImpulse1 == 0.0f && c.tangentImpulse2 == 0.0f) {
+				continue;
+			}
+
+			glm::vec3 impulse = c.normal * c.normalImpulse + c.tangent1 * c.tangentImpulse1 + c.tangent2 * c.tangentImpulse2;
+			if (c.inverseMass1 > 0.0f) addBodyVelocity(world, c.body1, -impulse * c.inverseMass1);
+			if (c.inverseMass2 > 0.0f) addBodyVelocity(world, c.body2, impulse * c.inverseMass2);
+			residual.warmStarted++;
+		}
+
+		for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+			float iterationResidual = 0.0f;
+			for (uint32_t i = begin; i < end; i++) {
+				iterationResidual += applyImpulses(world, constraints[i]);
+			}
+			if (iteration == 0) residual.initial = iterationResidual;
+			residual.final = iterationResidual;
+		}
+		return residual;
+	}
+
+	void ContactSolver::endStep() {
+		nextCache.clear();
+		for (const auto& c : constraints) {
+			nextCache.push_back({pairKey(c.body1, c.body2), c.normal, c.normalImpulse, c.tangentImpulse1, c.tangentImpulse2});
+		}
+		std::sort(nextCache.begin(), nextCache.end(), [](const CachedImpulse& a, const CachedImpulse& b) {
+			return a.key < b.key;
+		});
+		std::swap(cache, nextCache);
+	}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "physics_world.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	struct ContactConstraint {
+		uint32_t body1;
+		uint32_t body2;
+		// Points from body1 towards body2
+		glm::vec3 normal;
+		glm::vec3 tangent1;
+		glm::vec3 tangent2;
+		float inverseMass1;
+		float inverseMass2;
+		float effectiveMass;
+		float velocityBias;
+		// Accumulated over the solver iterations and carried to the next step
+		float normalImpulse;
+		float tangentImpulse1;
+		float tangentImpulse2;
+	};
+
+	struct SolverResidual {
+		// Sum of impulse changes in the first and last iteration
+		float initial;
+		float final;
+		uint32_t warmStarted;
+	};
+
+	// Iterative sequential-impulse solver for axis-aligned box contacts, including contacts
+	// with the ground plane (PhysicsWorld::groundBody). It runs on velocities before they are
+	// integrated into positions. Accumulated impulses are cached per body pair between steps
+	// and applied up front (warm starting), so resting stacks converge in a few iterations
+	// instead of re-solving from scratch.
+	class ContactSolver {
+	public:
+		void setIterations(uint32_t count) { iterations = count; }
+		uint32_t getIterations() const { return iterations; }
+		void setRestitution(float value) { restitution = value; }
+		void setFriction(float value) { friction = value; }
+		void setGroundY(float value) { groundY = value; }
+
+		void beginStep(size_t contactCount);
+		// Builds, warm starts and solves the constraints for contacts [begin, begin + count).
+		// Calls for disjoint islands may run concurrently.
+		SolverResidual solve(PhysicsWorld& world, const std::vector<BodyPair>& contacts, uint32_t begin, uint32_t count, float deltaTime);
+		// Stores this step's accumulated impulses for warm starting the next one
+		void endStep();
+		void clearCache();
+
+	private:
+		struct CachedImpulse {
+			uint64_t key;
+			glm::vec3 normal;
+			float normalImpulse;
+			float tangentImpulse1;
+			float tangentImpulse2;
+		};
+
+		static uint64_t pairKey(uint32_t a, uint32_t b) {
+			return (static_cast<uint64_t>(a) << 32) | b;
+		}
+
+		ContactConstraint prepare(const PhysicsWorld& world, const BodyPair& contact, float deltaTime) const;
+		const CachedImpulse* findCached(uint64_t key) const;
+		float applyImpulses(PhysicsWorld& world, ContactConstraint& c) const;
+
+		uint32_t iterations = 8;
+		float restitution = 0.7f;
+		float friction = 0.4f;
+		float groundY = 0.0f;
+		// Closing speeds below this are treated as resting contact and don't bounce
+		const float restitutionThreshold = 1.0f;
+		// Fraction of the penetration fed back into the velocity each step
+		const float baumgarte = 0.2f;
+		const float penetrationSlop = 0.005f;
+
+		std::vector<ContactConstraint> constraints;
+		// Sorted by key so lookups are a binary search without per-node allocations
+		std::vector<CachedImpulse> cache;
+		std::vector<CachedImpulse> nextCache;
+	};
+
+}
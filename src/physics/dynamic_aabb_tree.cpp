@@ -0,0 +1,263 @@
+#include "dynamic_aabb_tree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace yellowstone {
+
+	DynamicAABBTree::DynamicAABBTree(float fatMargin) : fatMargin{fatMargin} {}
+
+	int32_t DynamicAABBTree::allocateNode() {
+		if (freeList == nullNode) {
+			nodes.emplace_back();
+			nodes.back().height = 0;
+			return static_cast<int32_t>(nodes.size() - 1);
+		}
+
+		int32_t index = freeList;
+		freeList = nodes[index].parent;
+		nodes[index] = Node{};
+		nodes[index].height = 0;
+		return index;
+	}
+
+	void DynamicAABBTree::freeNode(int32_t node) {
+		nodes[node].parent = freeList;
+		nodes[node].height = -1;
+		freeList = node;
+	}
+
+	void DynamicAABBTree::clear() {
+		nodes.clear();
+		root = nullNode;
+		freeList = nullNode;
+		proxyCount = 0;
+	}
+
+	int32_t DynamicAABBTree::createProxy(const AABB& box, uint32_t userData) {
+		int32_t proxy = allocateNode();
+		nodes[proxy].box = box.expanded(fatMargin);
+		nodes[proxy].userData = userData;
+		insertLeaf(proxy);
+		proxyCount++;
+		return proxy;
+	}
+
+	void DynamicAABBTree::destroyProxy(int32_t proxy) {
+		assert(nodes[proxy].isLeaf() && "Can only destroy leaf proxies");
+		removeLeaf(proxy);
+		freeNode(proxy);
+		proxyCount--;
+	}
+
+	bool DynamicAABBTree::moveProxy(int32_t proxy, const AABB& box) {
+		assert(nodes[proxy].isLeaf() && "Can only move leaf proxies");
+		if (nodes[proxy].box.contains(box)) {
+			return false;
+		}
+
+		removeLeaf(proxy);
+		nodes[proxy].box = box.expanded(fatMargin);
+		insertLeaf(proxy);
+		return true;
+	}
+
+	void DynamicAABBTree::insertLeaf(int32_t leaf) {
+		if (root == nullNode) {
+			root = leaf;
+			nodes[root].parent = nullNode;
+			return;
+		}
+
+		// Descend towards the sibling that grows the total surface area the least
+		AABB leafBox = nodes[leaf].box;
+		int32_t index = root;
+		while (!nodes[index].isLeaf()) {
+			const Node& node = nodes[index];
+			float area = node.box.surfaceArea();
+			float combinedArea = AABB::merge(node.box, leafBox).surfaceArea();
+
+			// Cost of creating a new parent for this node and the new leaf
+			float cost = 2.0f * combinedArea;
+			// Minimum cost of pushing the leaf further down the tree
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [&](int32_t child) {
+				const Node& c = nodes[child];
+				float merged = AABB::merge(leafBox, c.box).surfaceArea();
+				return (c.isLeaf() ? merged : merged - c.box.surfaceArea()) + inheritanceCost;
+			};
+			float cost1 = descendCost(node.child1);
+			float cost2 = descendCost(node.child2);
+
+			if (cost < cost1 && cost < cost2) break;
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		int32_t sibling = index;
+		int32_t oldParent = nodes[sibling].parent;
+		int32_t newParent = allocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].box = AABB::merge(leafBox, nodes[sibling].box);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		if (oldParent != nullNode) {
+			if (nodes[oldParent].child1 == sibling) {
+				nodes[oldParent].child1 = newParent;
+			} else {
+				nodes[oldParent].child2 = newParent;
+			}
+		} else {
+			root = newParent;
+		}
+
+		refitAncestors(nodes[leaf].parent);
+	}
+
+	void DynamicAABBTree::removeLeaf(int32_t leaf) {
+		if (leaf == root) {
+			root = nullNode;
+			return;
+		}
+
+		int32_t parent = nodes[leaf].parent;
+		int32_t grandParent = nodes[parent].parent;
+		int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent != nullNode) {
+			// Replace the parent with the sibling and refit from there
+			if (nodes[grandParent].child1 == parent) {
+				nodes[grandParent].child1 = sibling;
+			} else {
+				nodes[grandParent].child2 = sibling;
+			}
+			nodes[sibling].parent = grandParent;
+			freeNode(parent);
+			refitAncestors(grandParent);
+		} else {
+			root = sibling;
+			nodes[sibling].parent = nullNode;
+			freeNode(parent);
+		}
+	}
+
+	void DynamicAABBTree::refitAncestors(int32_t index) {
+		while (index != nullNode) {
+			index = balance(index);
+
+			Node& node = nodes[index];
+			const Node& child1 = nodes[node.child1];
+			const Node& child2 = nodes[node.child2];
+			node.height = 1 + std::max(child1.height, child2.height);
+			node.box = AABB::merge(child1.box, child2.box);
+
+			index = node.parent;
+		}
+	}
+
+	int32_t DynamicAABBTree::balance(int32_t iA) {
+		Node& A = nodes[iA];
+		if (A.isLeaf() || A.height < 2) {
+			return iA;
+		}
+
+		int32_t iB = A.child1;
+		int32_t iC = A.child2;
+		Node& B = nodes[iB];
+		Node& C = nodes[iC];
+		int32_t balanceFactor = C.height - B.height;
+
+		// Rotate C up
+		if (balanceFactor > 1) {
+			int32_t iF = C.child1;
+			int32_t iG = C.child2;
+			Node& F = nodes[iF];
+			Node& G = nodes[iG];
+
+			C.child1 = iA;
+			C.parent = A.parent;
+			A.parent = iC;
+
+			if (C.parent != nullNode) {
+				if (nodes[C.parent].child1 == iA) {
+					nodes[C.parent].child1 = iC;
+				} else {
+					nodes[C.parent].child2 = iC;
+				}
+			} else {
+				root = iC;
+			}
+
+			// Keep the taller of C's children at the top
+			if (F.height > G.height) {
+				C.child2 = iF;
+				A.child2 = iG;
+				G.parent = iA;
+				A.box = AABB::merge(B.box, G.box);
+				C.box = AABB::merge(A.box, F.box);
+				A.height = 1 + std::max(B.height, G.height);
+				C.height = 1 + std::max(A.height, F.height);
+			} else {
+				C.child2 = iG;
+				A.child2 = iF;
+				F.parent = iA;
+				A.box = AABB::merge(B.box, F.box);
+				C.box = AABB::merge(A.box, G.box);
+				A.height = 1 + std::max(B.height, F.height);
+				C.height = 1 + std::max(A.height, G.height);
+			}
+
+			return iC;
+		}
+
+		// Rotate B up
+		if (balanceFactor < -1) {
+			int32_t iD = B.child1;
+			int32_t iE = B.child2;
+			Node& D = nodes[iD];
+			Node& E = nodes[iE];
+
+			B.child1 = iA;
+			B.parent = A.parent;
+			A.parent = iB;
+
+			if (B.parent != nullNode) {
+				if (nodes[B.parent].child1 == iA) {
+					nodes[B.parent].child1 = iB;
+				} else {
+					nodes[B.parent].child2 = iB;
+				}
+			} else {
+				root = iB;
+			}
+
+			// Keep the taller of B's children at the top
+			if (D.height > E.height) {
+				B.child2 = iD;
+				A.child1 = iE;
+				E.parent = iA;
+				A.box = AABB::merge(C.box, E.box);
+				B.box = AABB::merge(A.box, D.box);
+				A.height = 1 + std::max(C.height, E.height);
+				B.height = 1 + std::max(A.height, D.height);
+			} else {
+				B.child2 = iE;
+				A.child1 = iD;
+				D.parent = iA;
+				A.box = AABB::merge(C.box, D.box);
+				B.box = AABB::merge(A.box, E.box);
+				A.height = 1 + std::max(C.height, D.height);
+				B.height = 1 + std::max(A.height, E.height);
+			}
+
+			return iB;
+		}
+
+		return iA;
+	}
+
+}
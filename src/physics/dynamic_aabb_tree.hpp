@@ -0,0 +1,142 @@
+#pragma once
+
+#include "aabb.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	// Bounding volume hierarchy over enlarged ("fat") AABBs. Leaves are only reinserted when
+	// the tight box escapes its fat box, and the tree is kept balanced with AVL-style
+	// rotations on the way back up from every insert and removal. Nodes live in a single
+	// pool and refer to each other by index, so the tree never allocates per node.
+	class DynamicAABBTree {
+	public:
+		static constexpr int32_t nullNode = -1;
+
+		explicit DynamicAABBTree(float fatMargin = 0.1f);
+
+		int32_t createProxy(const AABB& box, uint32_t userData);
+		void destroyProxy(int32_t proxy);
+		// Returns true if the proxy had to be reinserted
+		bool moveProxy(int32_t proxy, const AABB& box);
+		void clear();
+
+		const AABB& getFatAABB(int32_t proxy) const { return nodes[proxy].box; }
+		uint32_t getUserData(int32_t proxy) const { return nodes[proxy].userData; }
+		int32_t getHeight() const { return root == nullNode ? 0 : nodes[root].height; }
+		size_t getProxyCount() const { return proxyCount; }
+
+		void setFatMargin(float margin) { fatMargin = margin; }
+		float getFatMargin() const { return fatMargin; }
+
+		// Calls callback(userData) for every leaf whose fat box overlaps 'box'.
+		// Returning false from the callback stops the query early.
+		template <typename Callback>
+		void query(const AABB& box, Callback&& callback) const {
+			TraversalStack stack;
+			if (root != nullNode) stack.push(root);
+
+			while (!stack.empty()) {
+				const Node& node = nodes[stack.pop()];
+				if (!node.box.overlaps(box)) continue;
+
+				if (node.isLeaf()) {
+					if (!callback(node.userData)) return;
+				} else {
+					stack.push(node.child1);
+					stack.push(node.child2);
+				}
+			}
+		}
+
+		// Calls callback(userData, maxDistance) for every leaf whose fat box the ray enters.
+		// The callback returns the new maximum distance, so returning the distance to an exact
+		// hit clips the rest of the traversal and returning 0 stops it.
+		template <typename Callback>
+		void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback&& callback) const {
+			glm::vec3 inverseDirection = 1.0f / direction;
+			TraversalStack stack;
+			if (root != nullNode) stack.push(root);
+
+			while (!stack.empty()) {
+				const Node& node = nodes[stack.pop()];
+				float distance;
+				if (!node.box.raycast(origin, inverseDirection, maxDistance, distance)) continue;
+
+				if (node.isLeaf()) {
+					maxDistance = callback(node.userData, maxDistance);
+					if (maxDistance <= 0.0f) return;
+				} else {
+					stack.push(node.child1);
+					stack.push(node.child2);
+				}
+			}
+		}
+
+	private:
+		// Pending nodes of a depth-first traversal. A balanced tree needs far less than the
+		// inline capacity even for millions of leaves; a deeper one moves the stack to the heap
+		// rather than writing past its end.
+		class TraversalStack {
+		public:
+			TraversalStack() = default;
+			TraversalStack(const TraversalStack&) = delete;
+			TraversalStack& operator=(const TraversalStack&) = delete;
+
+			void push(int32_t node) {
+				if (count == capacity) grow();
+				data[count++] = node;
+			}
+			int32_t pop() { return data[--count]; }
+			bool empty() const { return count == 0; }
+
+		private:
+			static constexpr int32_t inlineCapacity = 256;
+
+			void grow() {
+				heap.resize(static_cast<size_t>(capacity) * 2);
+				if (data == inlineStorage) {
+					std::copy(inlineStorage, inlineStorage + count, heap.begin());
+				}
+				data = heap.data();
+				capacity *= 2;
+			}
+
+			int32_t inlineStorage[inlineCapacity];
+			std::vector<int32_t> heap;
+			int32_t* data = inlineStorage;
+			int32_t count = 0;
+			int32_t capacity = inlineCapacity;
+		};
+
+		struct Node {
+			AABB box;
+			// Parent index, or the next free node while the node is in the free list
+			int32_t parent = nullNode;
+			int32_t child1 = nullNode;
+			int32_t child2 = nullNode;
+			// Leaves have height 0, free nodes -1
+			int32_t height = -1;
+			uint32_t userData = 0;
+
+			bool isLeaf() const { return child1 == nullNode; }
+		};
+
+		int32_t allocateNode();
+		void freeNode(int32_t node);
+		void insertLeaf(int32_t leaf);
+		void removeLeaf(int32_t leaf);
+		void refitAncestors(int32_t index);
+		int32_t balance(int32_t index);
+
+		std::vector<Node> nodes;
+		int32_t root = nullNode;
+		int32_t freeList = nullNode;
+		size_t proxyCount = 0;
+		float fatMargin;
+	};
+
+}
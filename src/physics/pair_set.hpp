@@ -0,0 +1,105 @@
+#pragma once
+
+#include "aabb.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace yellowstone {
+
+	// Dense list of body pairs with O(1) add/remove, used by broadphases that keep their
+	// overlapping pairs between steps
+	class PairSet {
+	public:
+		bool add(uint32_t a, uint32_t b) {
+			if (a > b) std::swap(a, b);
+			uint64_t key = pairKey(a, b);
+			if (indices.count(key) != 0) {
+				return false;
+			}
+			indices[key] = static_cast<uint32_t>(pairs.size());
+			pairs.emplace_back(a, b);
+			references.push_back(1);
+			return true;
+		}
+
+		// Counted add for broadphases that can find the same pair in more than one place. The
+		// pair stays in the set until removeReference() has been called once per addReference().
+		void addReference(uint32_t a, uint32_t b) {
+			if (a > b) std::swap(a, b);
+			auto it = indices.find(pairKey(a, b));
+			if (it != indices.end()) {
+				references[it->second]++;
+				return;
+			}
+			add(a, b);
+		}
+
+		void removeReference(uint32_t a, uint32_t b) {
+			if (a > b) std::swap(a, b);
+			auto it = indices.find(pairKey(a, b));
+			if (it == indices.end() || --references[it->second] != 0) {
+				return;
+			}
+			uint32_t index = it->second;
+			indices.erase(it);
+			removeAt(index);
+		}
+
+		bool remove(uint32_t a, uint32_t b) {
+			if (a > b) std::swap(a, b);
+			auto it = indices.find(pairKey(a, b));
+			if (it == indices.end()) {
+				return false;
+			}
+			uint32_t index = it->second;
+			indices.erase(it);
+			removeAt(index);
+			return true;
+		}
+
+		// Removes every pair for which predicate(pair) is true
+		template <typename Predicate>
+		void removeIf(Predicate&& predicate) {
+			// Walk backwards so the swap-remove only pulls in pairs that were already visited
+			for (size_t i = pairs.size(); i-- > 0;) {
+				if (predicate(pairs[i])) {
+					indices.erase(pairKey(pairs[i].first, pairs[i].second));
+					removeAt(static_cast<uint32_t>(i));
+				}
+			}
+		}
+
+		void clear() {
+			pairs.clear();
+			references.clear();
+			indices.clear();
+		}
+
+		size_t size() const { return pairs.size(); }
+		const std::vector<BodyPair>& getPairs() const { return pairs; }
+
+	private:
+		static uint64_t pairKey(uint32_t a, uint32_t b) {
+			return (static_cast<uint64_t>(a) << 32) | b;
+		}
+
+		void removeAt(uint32_t index) {
+			// Swap-remove to keep the pair list dense
+			if (index + 1 != pairs.size()) {
+				pairs[index] = pairs.back();
+				references[index] = references.back();
+				indices[pairKey(pairs[index].first, pairs[index].second)] = index;
+			}
+			pairs.pop_back();
+			references.pop_back();
+		}
+
+		std::vector<BodyPair> pairs;
+		std::vector<uint32_t> references;
+		std::unordered_map<uint64_t, uint32_t> indices;
+	};
+
+}
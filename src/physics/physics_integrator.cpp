@@ -0,0 +1,164 @@
+#include "physics_integrator.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define YELLOWSTONE_INTEGRATOR_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YELLOWSTONE_INTEGRATOR_SSE2
+#endif
+
+namespace yellowstone {
+
+	namespace {
+
+		struct BodyArrays {
+			float* px;
+			float* py;
+			float* pz;
+			float* vx;
+			float* vy;
+			float* vz;
+			const float* hy;
+		};
+
+		void integrateVelocitiesScalar(const BodyArrays& b, size_t begin, size_t end, const IntegrationSettings& s) {
+			for (size_t i = begin; i < end; i++) {
+				// Apply gravity
+				b.vy[i] += s.gravity * s.deltaTime;
+
+				// Apply simple damping to prevent infinite bouncing
+				b.vx[i] *= s.linearDamping;
+				b.vy[i] *= s.linearDamping;
+				b.vz[i] *= s.linearDamping;
+			}
+		}
+
+		void integratePositionsScalar(const BodyArrays& b, size_t begin, size_t end, const IntegrationSettings& s) {
+			for (size_t i = begin; i < end; i++) {
+				b.px[i] += b.vx[i] * s.deltaTime;
+				b.py[i] += b.vy[i] * s.deltaTime;
+				b.pz[i] += b.vz[i] * s.deltaTime;
+
+				// In Y-down system: bodies below ground (positive Y) are put back on top of it
+				b.py[i] = std::min(b.py[i], s.groundY - b.hy[i]);
+			}
+		}
+
+#if defined(YELLOWSTONE_INTEGRATOR_AVX2)
+
+		size_t integrateVelocitiesSimd(const BodyArrays& b, size_t count, const IntegrationSettings& s) {
+			const __m256 gravityStep = _mm256_set1_ps(s.gravity * s.deltaTime);
+			const __m256 damping = _mm256_set1_ps(s.linearDamping);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 vy = _mm256_add_ps(_mm256_loadu_ps(b.vy + i), gravityStep);
+				_mm256_storeu_ps(b.vx + i, _mm256_mul_ps(_mm256_loadu_ps(b.vx + i), damping));
+				_mm256_storeu_ps(b.vy + i, _mm256_mul_ps(vy, damping));
+				_mm256_storeu_ps(b.vz + i, _mm256_mul_ps(_mm256_loadu_ps(b.vz + i), damping));
+			}
+			return i;
+		}
+
+		size_t integratePositionsSimd(const BodyArrays& b, size_t count, const IntegrationSettings& s) {
+			const __m256 dt = _mm256_set1_ps(s.deltaTime);
+			const __m256 groundY = _mm256_set1_ps(s.groundY);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 px = _mm256_add_ps(_mm256_loadu_ps(b.px + i), _mm256_mul_ps(_mm256_loadu_ps(b.vx + i), dt));
+				__m256 py = _mm256_add_ps(_mm256_loadu_ps(b.py + i), _mm256_mul_ps(_mm256_loadu_ps(b.vy + i), dt));
+				__m256 pz = _mm256_add_ps(_mm256_loadu_ps(b.pz + i), _mm256_mul_ps(_mm256_loadu_ps(b.vz + i), dt));
+				py = _mm256_min_ps(py, _mm256_sub_ps(groundY, _mm256_loadu_ps(b.hy + i)));
+
+				_mm256_storeu_ps(b.px + i, px);
+				_mm256_storeu_ps(b.py + i, py);
+				_mm256_storeu_ps(b.pz + i, pz);
+			}
+			return i;
+		}
+
+#elif defined(YELLOWSTONE_INTEGRATOR_SSE2)
+
+		size_t integrateVelocitiesSimd(const BodyArrays& b, size_t count, const IntegrationSettings& s) {
+			const __m128 gravityStep = _mm_set1_ps(s.gravity * s.deltaTime);
+			const __m128 damping = _mm_set1_ps(s.linearDamping);
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 vy = _mm_add_ps(_mm_loadu_ps(b.vy + i), gravityStep);
+				_mm_storeu_ps(b.vx + i, _mm_mul_ps(_mm_loadu_ps(b.vx + i), damping));
+				_mm_storeu_ps(b.vy + i, _mm_mul_ps(vy, damping));
+				_mm_storeu_ps(b.vz + i, _mm_mul_ps(_mm_loadu_ps(b.vz + i), damping));
+			}
+			return i;
+		}
+
+		size_t integratePositionsSimd(const BodyArrays& b, size_t count, const IntegrationSettings& s) {
+			const __m128 dt = _mm_set1_ps(s.deltaTime);
+			const __m128 groundY = _mm_set1_ps(s.groundY);
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 px = _mm_add_ps(_mm_loadu_ps(b.px + i), _mm_mul_ps(_mm_loadu_ps(b.vx + i), dt));
+				__m128 py = _mm_add_ps(_mm_loadu_ps(b.py + i), _mm_mul_ps(_mm_loadu_ps(b.vy + i), dt));
+				__m128 pz = _mm_add_ps(_mm_loadu_ps(b.pz + i), _mm_mul_ps(_mm_loadu_ps(b.vz + i), dt));
+				py = _mm_min_ps(py, _mm_sub_ps(groundY, _mm_loadu_ps(b.hy + i)));
+
+				_mm_storeu_ps(b.px + i, px);
+				_mm_storeu_ps(b.py + i, py);
+				_mm_storeu_ps(b.pz + i, pz);
+			}
+			return i;
+		}
+
+#else
+
+		size_t integrateVelocitiesSimd(const BodyArrays&, size_t, const IntegrationSettings&) {
+			return 0;
+		}
+
+		size_t integratePositionsSimd(const BodyArrays&, size_t, const IntegrationSettings&) {
+			return 0;
+		}
+
+#endif
+
+		BodyArrays getArrays(PhysicsWorld& world) {
+			return {
+				world.positionX.data(), world.positionY.data(), world.positionZ.data(),
+				world.velocityX.data(), world.velocityY.data(), world.velocityZ.data(),
+				world.halfExtentY.data()
+			};
+		}
+
+	}
+
+	void integrateVelocities(PhysicsWorld& world, const IntegrationSettings& settings) {
+		BodyArrays arrays = getArrays(world);
+		size_t count = world.getAwakeCount();
+		size_t done = integrateVelocitiesSimd(arrays, count, settings);
+		integrateVelocitiesScalar(arrays, done, count, settings);
+	}
+
+	void integratePositions(PhysicsWorld& world, const IntegrationSettings& settings) {
+		BodyArrays arrays = getArrays(world);
+		size_t count = world.getAwakeCount();
+		size_t done = integratePositionsSimd(arrays, count, settings);
+		integratePositionsScalar(arrays, done, count, settings);
+	}
+
+	const char* getIntegratorBackendName() {
+#if defined(YELLOWSTONE_INTEGRATOR_AVX2)
+		return "avx2";
+#elif defined(YELLOWSTONE_INTEGRATOR_SSE2)
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "physics_world.hpp"
+
+namespace yellowstone {
+
+	struct IntegrationSettings {
+		float deltaTime;
+		float gravity;
+		float groundY;
+		float linearDamping;
+	};
+
+	// The two halves of a step for every awake body, with contacts solved in between so the
+	// solver works on the velocities that are about to move the bodies. Both use AVX2 (8 bodies
+	// per instruction) or SSE2 (4 bodies) when the compiler targets them, with a scalar loop for
+	// the remainder.
+	//
+	// integrateVelocities applies gravity and damping. integratePositions advances positions by
+	// the solved velocities and keeps bodies from sinking through the ground plane; bouncing
+	// off the ground is left to the contact solver.
+	void integrateVelocities(PhysicsWorld& world, const IntegrationSettings& settings);
+	void integratePositions(PhysicsWorld& world, const IntegrationSettings& settings);
+
+	const char* getIntegratorBackendName();
+
+}
@@ -0,0 +1,104 @@
+#include "physics_world.hpp"
+
+#include <utility>
+
+namespace yellowstone {
+
+	uint32_t PhysicsWorld::addBody(uint64_t id, const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& halfExtent, float mass) {
+		uint32_t body = static_cast<uint32_t>(ids.size());
+		ids.push_back(id);
+		slots.push_back(body);
+
+		bodies.push_back(body);
+		positionX.push_back(position.x);
+		positionY.push_back(position.y);
+		positionZ.push_back(position.z);
+		velocityX.push_back(velocity.x);
+		velocityY.push_back(velocity.y);
+		velocityZ.push_back(velocity.z);
+		halfExtentX.push_back(halfExtent.x);
+		halfExtentY.push_back(halfExtent.y);
+		halfExtentZ.push_back(halfExtent.z);
+		inverseMass.push_back(mass > 0.0f ? 1.0f / mass : 0.0f);
+		sleepTimer.push_back(0.0f);
+
+		// New bodies start awake; move it in front of any sleeping ones
+		swapSlots(slots[body], awakeCount);
+		awakeCount++;
+		return body;
+	}
+
+	void PhysicsWorld::clear() {
+		ids.clear();
+		slots.clear();
+		bodies.clear();
+		positionX.clear();
+		positionY.clear();
+		positionZ.clear();
+		velocityX.clear();
+		velocityY.clear();
+		velocityZ.clear();
+		halfExtentX.clear();
+		halfExtentY.clear();
+		halfExtentZ.clear();
+		inverseMass.clear();
+		sleepTimer.clear();
+		awakeCount = 0;
+	}
+
+	void PhysicsWorld::reserve(size_t count) {
+		ids.reserve(count);
+		slots.reserve(count);
+		bodies.reserve(count);
+		positionX.reserve(count);
+		positionY.reserve(count);
+		positionZ.reserve(count);
+		velocityX.reserve(count);
+		velocityY.reserve(count);
+		velocityZ.reserve(count);
+		halfExtentX.reserve(count);
+		halfExtentY.reserve(count);
+		halfExtentZ.reserve(count);
+		inverseMass.reserve(count);
+		sleepTimer.reserve(count);
+	}
+
+	void PhysicsWorld::wake(uint32_t body) {
+		if (isAwake(body)) {
+			return;
+		}
+		swapSlots(slots[body], awakeCount);
+		sleepTimer[awakeCount] = 0.0f;
+		awakeCount++;
+	}
+
+	void PhysicsWorld::sleep(uint32_t body) {
+		if (!isAwake(body)) {
+			return;
+		}
+		awakeCount--;
+		swapSlots(slots[body], awakeCount);
+		setVelocity(awakeCount, glm::vec3{0.0f});
+	}
+
+	void PhysicsWorld::swapSlots(uint32_t a, uint32_t b) {
+		if (a == b) {
+			return;
+		}
+		std::swap(bodies[a], bodies[b]);
+		std::swap(positionX[a], positionX[b]);
+		std::swap(positionY[a], positionY[b]);
+		std::swap(positionZ[a], positionZ[b]);
+		std::swap(velocityX[a], velocityX[b]);
+		std::swap(velocityY[a], velocityY[b]);
+		std::swap(velocityZ[a], velocityZ[b]);
+		std::swap(halfExtentX[a], halfExtentX[b]);
+		std::swap(halfExtentY[a], halfExtentY[b]);
+		std::swap(halfExtentZ[a], halfExtentZ[b]);
+		std::swap(inverseMass[a], inverseMass[b]);
+		std::swap(sleepTimer[a], sleepTimer[b]);
+		slots[bodies[a]] = a;
+		slots[bodies[b]] = b;
+	}
+
+}
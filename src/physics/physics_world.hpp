@@ -0,0 +1,76 @@
+#pragma once
+
+#include "aabb.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	// Dense structure-of-arrays storage for dynamic bodies. Each field lives in its own
+	// array so the integrator can stream through them several bodies at a time.
+	//
+	// Bodies are referred to by a stable body index. Their state lives in slots, which are
+	// kept partitioned so awake bodies occupy [0, getAwakeCount()) and sleeping bodies
+	// cost nothing to skip.
+	class PhysicsWorld {
+	public:
+		// Stands in for the ground plane as the second body of a contact. It has no slot and
+		// never moves, so check for it before looking a contact's second body up.
+		static constexpr uint32_t groundBody = ~0u;
+
+		uint32_t addBody(uint64_t id, const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& halfExtent, float mass);
+		void clear();
+		void reserve(size_t count);
+
+		size_t size() const { return ids.size(); }
+		uint32_t getAwakeCount() const { return awakeCount; }
+		uint32_t getSleepingCount() const { return static_cast<uint32_t>(size()) - awakeCount; }
+
+		uint32_t getSlot(uint32_t body) const { return slots[body]; }
+		bool isAwake(uint32_t body) const { return slots[body] < awakeCount; }
+		void wake(uint32_t body);
+		void sleep(uint32_t body);
+
+		// Slot accessors
+		glm::vec3 getPosition(uint32_t slot) const { return {positionX[slot], positionY[slot], positionZ[slot]}; }
+		glm::vec3 getVelocity(uint32_t slot) const { return {velocityX[slot], velocityY[slot], velocityZ[slot]}; }
+		glm::vec3 getHalfExtent(uint32_t slot) const { return {halfExtentX[slot], halfExtentY[slot], halfExtentZ[slot]}; }
+
+		void setPosition(uint32_t slot, const glm::vec3& p) {
+			positionX[slot] = p.x;
+			positionY[slot] = p.y;
+			positionZ[slot] = p.z;
+		}
+
+		void setVelocity(uint32_t slot, const glm::vec3& v) {
+			velocityX[slot] = v.x;
+			velocityY[slot] = v.y;
+			velocityZ[slot] = v.z;
+		}
+
+		AABB getBounds(uint32_t slot) const {
+			glm::vec3 p = getPosition(slot);
+			glm::vec3 h = getHalfExtent(slot);
+			return {p - h, p + h};
+		}
+
+		// Indexed by body; the id of whatever owns the body, e.g. an entity handle
+		std::vector<uint64_t> ids;
+		std::vector<uint32_t> slots;
+
+		// Indexed by slot
+		std::vector<uint32_t> bodies;
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<float> velocityX, velocityY, velocityZ;
+		std::vector<float> halfExtentX, halfExtentY, halfExtentZ;
+		std::vector<float> inverseMass;
+		std::vector<float> sleepTimer;
+
+	private:
+		void swapSlots(uint32_t a, uint32_t b);
+
+		uint32_t awakeCount = 0;
+	};
+
+}
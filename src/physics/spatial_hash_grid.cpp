@@ -0,0 +1,104 @@
+#include "spatial_hash_grid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace yellowstone {
+
+	SpatialHashGrid::SpatialHashGrid(float cellSize) {
+		setCellSize(cellSize);
+	}
+
+	void SpatialHashGrid::setCellSize(float size) {
+		assert(size > 0.0f && "Cell size must be positive");
+		cellSize = size;
+		inverseCellSize = 1.0f / size;
+	}
+
+	SpatialHashGrid::CellCoord SpatialHashGrid::toCell(const glm::vec3& p) const {
+		return {
+			static_cast<int32_t>(std::floor(p.x * inverseCellSize)),
+			static_cast<int32_t>(std::floor(p.y * inverseCellSize)),
+			static_cast<int32_t>(std::floor(p.z * inverseCellSize))
+		};
+	}
+
+	uint32_t SpatialHashGrid::hashCell(const CellCoord& cell) {
+		// Large primes from Teschner et al., "Optimized Spatial Hashing for Collision Detection"
+		return (static_cast<uint32_t>(cell.x) * 73856093u) ^
+		       (static_cast<uint32_t>(cell.y) * 19349663u) ^
+		       (static_cast<uint32_t>(cell.z) * 83492791u);
+	}
+
+	void SpatialHashGrid::update(const std::vector<AABB>& bounds, const std::vector<uint32_t>&) {
+		bodyMinCells.resize(bounds.size());
+		unsortedEntries.clear();
+
+		for (uint32_t i = 0; i < bounds.size(); i++) {
+			CellCoord minCell = toCell(bounds[i].min);
+			CellCoord maxCell = toCell(bounds[i].max);
+			bodyMinCells[i] = minCell;
+
+			for (int32_t x = minCell.x; x <= maxCell.x; x++) {
+				for (int32_t y = minCell.y; y <= maxCell.y; y++) {
+					for (int32_t z = minCell.z; z <= maxCell.z; z++) {
+						unsortedEntries.push_back({{x, y, z}, i});
+					}
+				}
+			}
+		}
+
+		// Size the table to roughly twice the number of entries so buckets stay short
+		uint32_t bucketCount = 1;
+		while (bucketCount < unsortedEntries.size() * 2) {
+			bucketCount <<= 1;
+		}
+		bucketMask = bucketCount - 1;
+
+		// Counting sort entries by bucket, keeping everything in flat arrays
+		bucketStarts.assign(bucketCount + 1, 0);
+		for (const auto& entry : unsortedEntries) {
+			bucketStarts[(hashCell(entry.cell) & bucketMask) + 1]++;
+		}
+		for (uint32_t b = 0; b < bucketCount; b++) {
+			bucketStarts[b + 1] += bucketStarts[b];
+		}
+
+		entries.resize(unsortedEntries.size());
+		bucketCursors.assign(bucketStarts.begin(), bucketStarts.end() - 1);
+		for (const auto& entry : unsortedEntries) {
+			entries[bucketCursors[hashCell(entry.cell) & bucketMask]++] = entry;
+		}
+	}
+
+	void SpatialHashGrid::findPairs(std::vector<BodyPair>& pairs) {
+		uint32_t bucketCount = bucketMask + 1;
+		for (uint32_t b = 0; b < bucketCount; b++) {
+			uint32_t begin = bucketStarts[b];
+			uint32_t end = bucketStarts[b + 1];
+
+			for (uint32_t i = begin; i < end; i++) {
+				const CellEntry& a = entries[i];
+				for (uint32_t j = i + 1; j < end; j++) {
+					const CellEntry& e = entries[j];
+					// Different cells can hash into the same bucket
+					if (!(a.cell == e.cell)) continue;
+
+					// Only report the pair from the first cell both bodies occupy
+					const CellCoord& minA = bodyMinCells[a.body];
+					const CellCoord& minB = bodyMinCells[e.body];
+					CellCoord first{
+						std::max(minA.x, minB.x),
+						std::max(minA.y, minB.y),
+						std::max(minA.z, minB.z)
+					};
+					if (!(a.cell == first)) continue;
+
+					pairs.emplace_back(std::min(a.body, e.body), std::max(a.body, e.body));
+				}
+			}
+		}
+	}
+
+}
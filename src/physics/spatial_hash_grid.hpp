@@ -0,0 +1,50 @@
+#pragma once
+
+#include "broadphase.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	// Uniform grid broadphase. Every body is bucketed into each cell its AABB touches,
+	// and candidate pairs are emitted once, from the first cell both bodies share.
+	// Cell size should be on the order of the largest dynamic body.
+	class SpatialHashGrid : public Broadphase {
+	public:
+		explicit SpatialHashGrid(float cellSize = 1.0f);
+
+		void setCellSize(float size);
+		float getCellSize() const { return cellSize; }
+
+		// The grid is rebuilt from scratch every update, so there is no state to reset
+		void reset() override {}
+		void update(const std::vector<AABB>& bounds, const std::vector<uint32_t>& movedBodies) override;
+		void findPairs(std::vector<BodyPair>& pairs) override;
+
+	private:
+		struct CellCoord {
+			int32_t x, y, z;
+			bool operator==(const CellCoord& other) const { return x == other.x && y == other.y && z == other.z; }
+		};
+
+		struct CellEntry {
+			CellCoord cell;
+			uint32_t body;
+		};
+
+		CellCoord toCell(const glm::vec3& p) const;
+		static uint32_t hashCell(const CellCoord& cell);
+
+		float cellSize;
+		float inverseCellSize;
+
+		std::vector<CellCoord> bodyMinCells;
+		std::vector<CellEntry> unsortedEntries;
+		std::vector<CellEntry> entries;
+		std::vector<uint32_t> bucketStarts;
+		std::vector<uint32_t> bucketCursors;
+		uint32_t bucketMask = 0;
+	};
+
+}
@@ -0,0 +1,370 @@
+#include "sweep_and_prune.hpp"
+#include "../yellowstone_frame_arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace yellowstone {
+
+	namespace {
+
+		// Region coordinates are packed into 21 bits each for the lookup key
+		constexpr int32_t regionCoordLimit = (1 << 20) - 1;
+
+		int32_t toRegionCoord(float value, float regionSize) {
+			float scaled = std::floor(value / regionSize);
+			// Also catches NaN, which would otherwise be undefined to convert
+			if (!(scaled > -static_cast<float>(regionCoordLimit))) return -regionCoordLimit;
+			if (!(scaled < static_cast<float>(regionCoordLimit))) return regionCoordLimit;
+			return static_cast<int32_t>(scaled);
+		}
+
+		uint64_t regionKey(const int32_t coords[3]) {
+			uint64_t key = 0;
+			for (int axis = 0; axis < 3; axis++) {
+				key = (key << 21) | static_cast<uint64_t>((coords[axis] + regionCoordLimit) & 0x1fffff);
+			}
+			return key;
+		}
+
+	}
+
+	bool SweepAndPrune::RegionRange::contains(const int32_t coords[3]) const {
+		for (int axis = 0; axis < 3; axis++) {
+			if (coords[axis] < min[axis] || coords[axis] > max[axis]) return false;
+		}
+		return true;
+	}
+
+	bool SweepAndPrune::RegionRange::operator==(const RegionRange& other) const {
+		return std::equal(min, min + 3, other.min) && std::equal(max, max + 3, other.max);
+	}
+
+	void SweepAndPrune::reset() {
+		boxes.clear();
+		bodyRegions.clear();
+		regions.clear();
+		regionLookup.clear();
+		overlappingPairs.clear();
+	}
+
+	void SweepAndPrune::rebuild(const std::vector<AABB>& bounds) {
+		reset();
+		boxes = bounds;
+		uint32_t bodyCount = static_cast<uint32_t>(bounds.size());
+		if (bodyCount == 0) {
+			return;
+		}
+
+		// Size regions from the scene's average body density, but never smaller than the largest
+		// body. Flat scenes still get regions that deep on their thin axis.
+		glm::vec3 sceneMin{std::numeric_limits<float>::max()};
+		glm::vec3 sceneMax{-std::numeric_limits<float>::max()};
+		float largestExtent = 0.0f;
+		for (const AABB& box : bounds) {
+			sceneMin = glm::min(sceneMin, box.min);
+			sceneMax = glm::max(sceneMax, box.max);
+			for (int axis = 0; axis < 3; axis++) {
+				largestExtent = std::max(largestExtent, box.max[axis] - box.min[axis]);
+			}
+		}
+		float volume = 1.0f;
+		for (int axis = 0; axis < 3; axis++) {
+			volume *= std::max(sceneMax[axis] - sceneMin[axis], largestExtent);
+		}
+		regionSize = std::max(std::cbrt(volume * targetBodiesPerRegion / bodyCount), largestExtent * 1.01f);
+		if (!(regionSize > 0.0f) || !std::isfinite(regionSize)) {
+			regionSize = 1.0f;
+		}
+
+		// Rounding can still push a body of the largest size across 3 regions; grow and retry
+		bodyRegions.resize(bodyCount);
+		auto computeRanges = [&]() {
+			for (uint32_t i = 0; i < bodyCount; i++) {
+				if (!computeRange(bounds[i], bodyRegions[i].range)) return false;
+			}
+			return true;
+		};
+		while (!computeRanges()) {
+			regionSize *= 2.0f;
+		}
+
+		for (uint32_t i = 0; i < bodyCount; i++) {
+			BodyRegions& entry = bodyRegions[i];
+			const RegionRange& range = entry.range;
+			entry.count = 0;
+			int32_t coords[3];
+			for (coords[0] = range.min[0]; coords[0] <= range.max[0]; coords[0]++) {
+				for (coords[1] = range.min[1]; coords[1] <= range.max[1]; coords[1]++) {
+					for (coords[2] = range.min[2]; coords[2] <= range.max[2]; coords[2]++) {
+						uint32_t regionIndex = findOrCreateRegion(coords);
+						Region& region = regions[regionIndex];
+						uint32_t local = static_cast<uint32_t>(region.bodies.size());
+						region.bodies.push_back(i);
+						entry.memberships[entry.count++] = {regionIndex, local};
+						for (int axis = 0; axis < 3; axis++) {
+							region.endpoints[axis].push_back({bounds[i].min[axis], local, false});
+							region.endpoints[axis].push_back({bounds[i].max[axis], local, true});
+						}
+					}
+				}
+			}
+		}
+
+		FrameArenaScope arenaScope;
+		FrameVector<uint32_t> open;
+		for (Region& region : regions) {
+			for (int axis = 0; axis < 3; axis++) {
+				auto& list = region.endpoints[axis];
+				std::sort(list.begin(), list.end(), lessThan);
+
+				region.endpointPositions[axis].resize(list.size());
+				for (uint32_t p = 0; p < list.size(); p++) {
+					region.endpointPositions[axis][list[p].body * 2 + list[p].isMax] = p;
+				}
+			}
+
+			// Seed the region's pairs with a single sweep along x
+			open.clear();
+			for (const auto& endpoint : region.endpoints[0]) {
+				if (endpoint.isMax) {
+					open.erase(std::find(open.begin(), open.end(), endpoint.body));
+					continue;
+				}
+				uint32_t body = region.bodies[endpoint.body];
+				for (uint32_t other : open) {
+					uint32_t otherBody = region.bodies[other];
+					if (boxes[otherBody].overlaps(boxes[body]) && region.pairs.add(otherBody, body)) {
+						overlappingPairs.addReference(otherBody, body);
+					}
+				}
+				open.push_back(endpoint.body);
+			}
+		}
+	}
+
+	bool SweepAndPrune::computeRange(const AABB& box, RegionRange& range) const {
+		for (int axis = 0; axis < 3; axis++) {
+			range.min[axis] = toRegionCoord(box.min[axis], regionSize);
+			range.max[axis] = toRegionCoord(box.max[axis], regionSize);
+			if (range.max[axis] - range.min[axis] > 1) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t SweepAndPrune::findOrCreateRegion(const int32_t coords[3]) {
+		auto [it, inserted] = regionLookup.try_emplace(regionKey(coords), static_cast<uint32_t>(regions.size()));
+		if (inserted) {
+			regions.emplace_back();
+			std::copy(coords, coords + 3, regions.back().coords);
+		}
+		return it->second;
+	}
+
+	void SweepAndPrune::update(const std::vector<AABB>& bounds, const std::vector<uint32_t>& movedBodies) {
+		swapCount = 0;
+		if (bounds.size() != boxes.size()) {
+			rebuild(bounds);
+			return;
+		}
+
+		for (uint32_t i : movedBodies) {
+			const AABB& box = bounds[i];
+			AABB& previous = boxes[i];
+			if (box.min == previous.min && box.max == previous.max) {
+				continue;
+			}
+
+			RegionRange range;
+			if (!computeRange(box, range)) {
+				// The body grew past the region size
+				rebuild(bounds);
+				return;
+			}
+			previous = box;
+
+			BodyRegions& entry = bodyRegions[i];
+			if (range == entry.range) {
+				for (uint32_t k = 0; k < entry.count; k++) {
+					moveInRegion(regions[entry.memberships[k].region], entry.memberships[k].local, box);
+				}
+				continue;
+			}
+
+			// Leave the regions the body no longer overlaps, then join the new ones
+			RegionRange previousRange = entry.range;
+			for (uint32_t k = entry.count; k-- > 0;) {
+				Region& region = regions[entry.memberships[k].region];
+				if (range.contains(region.coords)) {
+					moveInRegion(region, entry.memberships[k].local, box);
+				} else {
+					removeFromRegion(i, k);
+				}
+			}
+			entry.range = range;
+
+			int32_t coords[3];
+			for (coords[0] = range.min[0]; coords[0] <= range.max[0]; coords[0]++) {
+				for (coords[1] = range.min[1]; coords[1] <= range.max[1]; coords[1]++) {
+					for (coords[2] = range.min[2]; coords[2] <= range.max[2]; coords[2]++) {
+						if (!previousRange.contains(coords)) {
+							insertIntoRegion(i, findOrCreateRegion(coords));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void SweepAndPrune::insertIntoRegion(uint32_t body, uint32_t regionIndex) {
+		Region& region = regions[regionIndex];
+		uint32_t local = static_cast<uint32_t>(region.bodies.size());
+		region.bodies.push_back(body);
+
+		BodyRegions& entry = bodyRegions[body];
+		assert(entry.count < maxRegionsPerBody && "Body overlaps too many sweep-and-prune regions");
+		entry.memberships[entry.count++] = {regionIndex, local};
+
+		const AABB& box = boxes[body];
+		for (int axis = 0; axis < 3; axis++) {
+			auto& list = region.endpoints[axis];
+			auto& positions = region.endpointPositions[axis];
+			uint32_t minPosition = static_cast<uint32_t>(list.size());
+			list.push_back({box.min[axis], local, false});
+			list.push_back({box.max[axis], local, true});
+			positions.push_back(minPosition);
+			positions.push_back(minPosition + 1);
+
+			// Both endpoints start past every other one, so sliding them into place reports each
+			// overlap they pass like any other move
+			moveEndpoint(region, axis, minPosition, box.min[axis]);
+			moveEndpoint(region, axis, positions[local * 2 + 1], box.max[axis]);
+		}
+	}
+
+	void SweepAndPrune::removeFromRegion(uint32_t body, uint32_t membership) {
+		BodyRegions& entry = bodyRegions[body];
+		uint32_t regionIndex = entry.memberships[membership].region;
+		uint32_t local = entry.memberships[membership].local;
+		Region& region = regions[regionIndex];
+
+		// The shared set keeps a pair while another region still reports it
+		region.pairs.removeIf([&](const BodyPair& pair) {
+			if (pair.first != body && pair.second != body) {
+				return false;
+			}
+			overlappingPairs.removeReference(pair.first, pair.second);
+			return true;
+		});
+
+		for (int axis = 0; axis < 3; axis++) {
+			auto& list = region.endpoints[axis];
+			auto& positions = region.endpointPositions[axis];
+			uint32_t minPosition = positions[local * 2];
+			uint32_t maxPosition = positions[local * 2 + 1];
+			list.erase(list.begin() + maxPosition);
+			list.erase(list.begin() + minPosition);
+			for (uint32_t p = minPosition; p < list.size(); p++) {
+				positions[list[p].body * 2 + list[p].isMax] = p;
+			}
+		}
+
+		// Fill the hole in the local indices with the region's last body
+		uint32_t last = static_cast<uint32_t>(region.bodies.size()) - 1;
+		if (local != last) {
+			uint32_t movedBody = region.bodies[last];
+			region.bodies[local] = movedBody;
+			for (int axis = 0; axis < 3; axis++) {
+				auto& positions = region.endpointPositions[axis];
+				for (uint32_t end = 0; end < 2; end++) {
+					uint32_t position = positions[last * 2 + end];
+					region.endpoints[axis][position].body = local;
+					positions[local * 2 + end] = position;
+				}
+			}
+			BodyRegions& movedEntry = bodyRegions[movedBody];
+			for (uint32_t k = 0; k < movedEntry.count; k++) {
+				if (movedEntry.memberships[k].region == regionIndex) {
+					movedEntry.memberships[k].local = local;
+				}
+			}
+		}
+		region.bodies.pop_back();
+		for (int axis = 0; axis < 3; axis++) {
+			region.endpointPositions[axis].resize(last * 2);
+		}
+
+		entry.memberships[membership] = entry.memberships[--entry.count];
+	}
+
+	void SweepAndPrune::moveInRegion(Region& region, uint32_t local, const AABB& box) {
+		for (int axis = 0; axis < 3; axis++) {
+			auto& positions = region.endpointPositions[axis];
+			uint32_t minPosition = positions[local * 2];
+			uint32_t maxPosition = positions[local * 2 + 1];
+			// Move the leading endpoint first so a body never sweeps across itself
+			if (box.min[axis] < region.endpoints[axis][minPosition].value) {
+				moveEndpoint(region, axis, minPosition, box.min[axis]);
+				moveEndpoint(region, axis, positions[local * 2 + 1], box.max[axis]);
+			} else {
+				moveEndpoint(region, axis, maxPosition, box.max[axis]);
+				moveEndpoint(region, axis, positions[local * 2], box.min[axis]);
+			}
+		}
+	}
+
+	void SweepAndPrune::moveEndpoint(Region& region, int axis, uint32_t position, float value) {
+		auto& list = region.endpoints[axis];
+		list[position].value = value;
+
+		// Insertion sort step in whichever direction the endpoint moved
+		while (position > 0 && lessThan(list[position], list[position - 1])) {
+			swapEndpoints(region, axis, position - 1, position);
+			position--;
+		}
+		while (position + 1 < list.size() && lessThan(list[position + 1], list[position])) {
+			swapEndpoints(region, axis, position, position + 1);
+			position++;
+		}
+	}
+
+	void SweepAndPrune::swapEndpoints(Region& region, int axis, uint32_t lower, uint32_t upper) {
+		auto& list = region.endpoints[axis];
+		// The endpoint at 'upper' is moving below the one at 'lower'
+		const Endpoint& moving = list[upper];
+		const Endpoint& passed = list[lower];
+		swapCount++;
+
+		if (moving.body != passed.body) {
+			uint32_t movingBody = region.bodies[moving.body];
+			uint32_t passedBody = region.bodies[passed.body];
+			if (!moving.isMax && passed.isMax) {
+				// A min crossed below a max: the bodies start overlapping on this axis
+				if (boxes[movingBody].overlaps(boxes[passedBody]) && region.pairs.add(movingBody, passedBody)) {
+					overlappingPairs.addReference(movingBody, passedBody);
+				}
+			} else if (moving.isMax && !passed.isMax) {
+				// A max crossed below a min: the bodies separate on this axis
+				if (region.pairs.remove(movingBody, passedBody)) {
+					overlappingPairs.removeReference(movingBody, passedBody);
+				}
+			}
+		}
+
+		std::swap(list[lower], list[upper]);
+		auto& positions = region.endpointPositions[axis];
+		positions[list[lower].body * 2 + list[lower].isMax] = lower;
+		positions[list[upper].body * 2 + list[upper].isMax] = upper;
+	}
+
+	void SweepAndPrune::findPairs(std::vector<BodyPair>& pairs) {
+		const auto& current = overlappingPairs.getPairs();
+		pairs.insert(pairs.end(), current.begin(), current.end());
+	}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "broadphase.hpp"
+#include "pair_set.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace yellowstone {
+
+	// Incremental sweep-and-prune. Space is split into a uniform grid of regions, and each
+	// region keeps its own sorted min/max endpoint lists per axis for the bodies overlapping
+	// it. Lists persist between steps and only the endpoints of bodies whose bounds changed
+	// are moved, so a mostly resting scene costs a few swaps per moving body. Every swap that
+	// starts or ends an overlap on one axis updates the region's set of overlapping pairs.
+	//
+	// A single list for the whole scene would get denser as the scene grows, so a body moving
+	// the same distance would cross more endpoints. Regions are sized at rebuild to hold about
+	// targetBodiesPerRegion bodies, which keeps the swaps per moving body independent of the
+	// total body count. Bodies near a region boundary are in up to 8 regions, and the shared
+	// pair set counts how many regions reported each pair.
+	class SweepAndPrune : public Broadphase {
+	public:
+		void reset() override;
+		void update(const std::vector<AABB>& bounds, const std::vector<uint32_t>& movedBodies) override;
+		void findPairs(std::vector<BodyPair>& pairs) override;
+
+		size_t getSwapCount() const { return swapCount; }
+		size_t getRegionCount() const { return regions.size(); }
+
+	private:
+		static constexpr uint32_t targetBodiesPerRegion = 128;
+		// Regions are never smaller than the largest body, so a body spans at most 2 per axis
+		static constexpr uint32_t maxRegionsPerBody = 8;
+
+		struct Endpoint {
+			float value;
+			// Index of the body within its region
+			uint32_t body;
+			bool isMax;
+		};
+
+		struct Region {
+			int32_t coords[3];
+			// Body index for each region-local index
+			std::vector<uint32_t> bodies;
+			std::vector<Endpoint> endpoints[3];
+			// Position of each local body's min (2 * local) and max (2 * local + 1) endpoint per axis
+			std::vector<uint32_t> endpointPositions[3];
+			PairSet pairs;
+		};
+
+		struct Membership {
+			uint32_t region;
+			uint32_t local;
+		};
+
+		struct RegionRange {
+			int32_t min[3];
+			int32_t max[3];
+
+			bool contains(const int32_t coords[3]) const;
+			bool operator==(const RegionRange& other) const;
+		};
+
+		struct BodyRegions {
+			RegionRange range;
+			uint32_t count;
+			Membership memberships[maxRegionsPerBody];
+		};
+
+		static bool lessThan(const Endpoint& a, const Endpoint& b) {
+			// Mins sort before maxes at equal values so touching boxes count as overlapping,
+			// matching AABB::overlaps
+			return a.value < b.value || (a.value == b.value && !a.isMax && b.isMax);
+		}
+
+		void rebuild(const std::vector<AABB>& bounds);
+		bool computeRange(const AABB& box, RegionRange& range) const;
+		uint32_t findOrCreateRegion(const int32_t coords[3]);
+
+		void insertIntoRegion(uint32_t body, uint32_t regionIndex);
+		void removeFromRegion(uint32_t body, uint32_t membership);
+		void moveInRegion(Region& region, uint32_t local, const AABB& box);
+		void moveEndpoint(Region& region, int axis, uint32_t position, float value);
+		void swapEndpoints(Region& region, int axis, uint32_t lower, uint32_t upper);
+
+		std::vector<AABB> boxes;
+		std::vector<BodyRegions> bodyRegions;
+
+		float regionSize = 1.0f;
+		std::vector<Region> regions;
+		std::unordered_map<uint64_t, uint32_t> regionLookup;
+
+		// Pairs reported by any region, counted once per region that reported them
+		PairSet overlappingPairs;
+		size_t swapCount = 0;
+	};
+
+}
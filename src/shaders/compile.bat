@@ -12,8 +12,8 @@ if %errorlevel%==0 (
   exit /b 1
 )
 
-REM Compile all .vert and .frag files in this directory
-for %%F in (*.vert *.frag) do (
+REM Compile all .vert, .frag and .comp files in this directory
+for %%F in (*.vert *.frag *.comp) do (
   if exist "%%F" (
     "%GLSLC%" "%%F" -o "%%F.spv"
   )
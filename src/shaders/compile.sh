@@ -13,8 +13,8 @@ echo "Error: glslc not found. Ensure it is in PATH or set VULKAN_SDK." >&2
 exit 1
 fi
 
-# Compile all .vert and .frag shaders in this directory.
-for src in *.vert *.frag; do
+# Compile all .vert, .frag and .comp shaders in this directory.
+for src in *.vert *.frag *.comp; do
     [ -e "$src" ] || continue
     "$GLSLC" "$src" -o "$src.spv"
 done
@@ -14,11 +14,6 @@ layout(set=0, binding=0) uniform GlobalUbo {
 	vec4 lightColor;
 } ubo;
 
-layout(push_constant) uniform Push {
-	mat4 modelMatrix;
-	mat4 normalMatrix;
-} push;
-
 void main() {
 	vec3 directionToLight = ubo.lightPosition - fragPosWorld;
 	float attenuation = 1.0 / dot(directionToLight, directionToLight); // distance squared
@@ -17,15 +17,33 @@ layout(set=0, binding=0) uniform GlobalUbo {
 	vec4 lightColor;
 } ubo;
 
-layout(push_constant) uniform Push {
+struct Instance {
 	mat4 modelMatrix;
 	mat4 normalMatrix;
+	vec4 color;
+	uint batch;
+};
+
+// One entry per object in the frame
+layout(std430, set=1, binding=0) readonly buffer InstanceBuffer {
+	Instance instances[];
+} instanceBuffer;
+
+// Objects that passed culling, written by cull.comp in a contiguous range per model
+layout(std430, set=1, binding=1) readonly buffer VisibleBuffer {
+	uint indices[];
+} visibleBuffer;
+
+layout(push_constant) uniform Push {
+	// Start of this draw's range in VisibleBuffer
+	uint firstInstance;
 } push;
 
 void main() {
-	vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+	Instance instance = instanceBuffer.instances[visibleBuffer.indices[push.firstInstance + gl_InstanceIndex]];
+	vec4 positionWorld = instance.modelMatrix * vec4(position, 1.0);
 	gl_Position = ubo.projection * ubo.view * positionWorld;
-	fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+	fragNormalWorld = normalize(mat3(instance.normalMatrix) * normal);
 	fragPosWorld = positionWorld.xyz;
-	fragColor = color;
+	fragColor = color * instance.color.rgb;
 }
\ No newline at end of file
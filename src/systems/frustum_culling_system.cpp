@@ -0,0 +1,194 @@
+#include "frustum_culling_system.hpp"
+#include "../yellowstone_model.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define YELLOWSTONE_CULLING_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YELLOWSTONE_CULLING_SSE2
+#endif
+
+namespace yellowstone {
+
+	namespace {
+
+		// World space spheres are built for this many objects at a time, so they stay on the
+		// stack and in cache between being built and tested
+		constexpr uint32_t sphereBatchSize = 256;
+
+		struct SphereArrays {
+			float x[sphereBatchSize];
+			float y[sphereBatchSize];
+			float z[sphereBatchSize];
+			float radius[sphereBatchSize];
+		};
+
+		void testScalar(const Frustum& frustum, const SphereArrays& s, uint32_t begin, uint32_t end, uint8_t* visible) {
+			for (uint32_t i = begin; i < end; i++) {
+				bool inside = true;
+				for (const glm::vec4& plane : frustum.planes) {
+					float distance = plane.x * s.x[i] + plane.y * s.y[i] + plane.z * s.z[i] + plane.w;
+					if (!(distance >= -s.radius[i])) {
+						inside = false;
+						break;
+					}
+				}
+				visible[i] = inside ? 1 : 0;
+			}
+		}
+
+#if defined(YELLOWSTONE_CULLING_AVX2)
+
+		uint32_t testSimd(const Frustum& frustum, const SphereArrays& s, uint32_t count, uint8_t* visible) {
+			const __m256 zero = _mm256_setzero_ps();
+			uint32_t i = 0;
+			for (; i + 8 <= count; i += 8) {
+				__m256 x = _mm256_loadu_ps(s.x + i);
+				__m256 y = _mm256_loadu_ps(s.y + i);
+				__m256 z = _mm256_loadu_ps(s.z + i);
+				__m256 negativeRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(s.radius + i));
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (const glm::vec4& plane : frustum.planes) {
+					__m256 distance = _mm256_add_ps(
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y)),
+						_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), z), _mm256_set1_ps(plane.w)));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+				}
+
+				int mask = _mm256_movemask_ps(inside);
+				for (uint32_t lane = 0; lane < 8; lane++) {
+					visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+				}
+			}
+			return i;
+		}
+
+#elif defined(YELLOWSTONE_CULLING_SSE2)
+
+		uint32_t testSimd(const Frustum& frustum, const SphereArrays& s, uint32_t count, uint8_t* visible) {
+			const __m128 zero = _mm_setzero_ps();
+			uint32_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				__m128 x = _mm_loadu_ps(s.x + i);
+				__m128 y = _mm_loadu_ps(s.y + i);
+				__m128 z = _mm_loadu_ps(s.z + i);
+				__m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(s.radius + i));
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (const glm::vec4& plane : frustum.planes) {
+					__m128 distance = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+				}
+
+				int mask = _mm_movemask_ps(inside);
+				for (uint32_t lane = 0; lane < 4; lane++) {
+					visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+				}
+			}
+			return i;
+		}
+
+#else
+
+		uint32_t testSimd(const Frustum&, const SphereArrays&, uint32_t, uint8_t*) {
+			return 0;
+		}
+
+#endif
+
+	}
+
+	Frustum Frustum::fromMatrix(const glm::mat4& projectionView) {
+		// Gribb-Hartmann: each plane is the last row of the matrix plus or minus another row
+		glm::vec4 row0{projectionView[0][0], projectionView[1][0], projectionView[2][0], projectionView[3][0]};
+		glm::vec4 row1{projectionView[0][1], projectionView[1][1], projectionView[2][1], projectionView[3][1]};
+		glm::vec4 row2{projectionView[0][2], projectionView[1][2], projectionView[2][2], projectionView[3][2]};
+		glm::vec4 row3{projectionView[0][3], projectionView[1][3], projectionView[2][3], projectionView[3][3]};
+
+		Frustum frustum{};
+		frustum.planes[0] = row3 + row0;
+		frustum.planes[1] = row3 - row0;
+		frustum.planes[2] = row3 + row1;
+		frustum.planes[3] = row3 - row1;
+		frustum.planes[4] = row2;
+		frustum.planes[5] = row3 - row2;
+		// Normalized so plane distances compare directly with sphere radii
+		for (glm::vec4& plane : frustum.planes) {
+			plane /= glm::length(glm::vec3{plane});
+		}
+		return frustum;
+	}
+
+	void FrustumCullingSystem::cull(const Frustum& frustum, const std::vector<RenderObject>& objects, YellowstoneThreadPool* threadPool) {
+		this->frustum = frustum;
+		this->objects = objects.data();
+		uint32_t count = static_cast<uint32_t>(objects.size());
+		visibility.resize(count);
+
+		uint32_t visibleObjects = 0;
+		if (threadPool == nullptr || count <= parallelChunkSize) {
+			visibleObjects = cullRange(0, count);
+		} else {
+			std::atomic<uint32_t> visibleCount{0};
+			threadPool->parallelFor(0, count, parallelChunkSize, [&](uint32_t chunkBegin, uint32_t chunkEnd) {
+				visibleCount.fetch_add(cullRange(chunkBegin, chunkEnd), std::memory_order_relaxed);
+			});
+			visibleObjects = visibleCount.load(std::memory_order_relaxed);
+		}
+
+		this->objects = nullptr;
+		stats.testedObjects = count;
+		stats.visibleObjects = visibleObjects;
+	}
+
+	uint32_t FrustumCullingSystem::cullRange(uint32_t begin, uint32_t end) {
+		uint32_t visibleObjects = 0;
+		SphereArrays spheres;
+		for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += sphereBatchSize) {
+			uint32_t batchCount = std::min(sphereBatchSize, end - batchBegin);
+
+			// Scale may be non-uniform, so the radius grows with the longest axis
+			for (uint32_t i = 0; i < batchCount; i++) {
+				const RenderObject& object = objects[batchBegin + i];
+				const glm::vec4& sphere = object.model->getBoundingSphere();
+				const glm::mat4& modelMatrix = object.matrices.modelMatrix;
+				glm::vec4 center = modelMatrix * glm::vec4{glm::vec3{sphere}, 1.0f};
+				float scaleSquared = std::max(std::max(
+					glm::dot(glm::vec3{modelMatrix[0]}, glm::vec3{modelMatrix[0]}),
+					glm::dot(glm::vec3{modelMatrix[1]}, glm::vec3{modelMatrix[1]})),
+					glm::dot(glm::vec3{modelMatrix[2]}, glm::vec3{modelMatrix[2]}));
+				spheres.x[i] = center.x;
+				spheres.y[i] = center.y;
+				spheres.z[i] = center.z;
+				spheres.radius[i] = sphere.w * std::sqrt(scaleSquared);
+			}
+
+			uint8_t* visible = visibility.data() + batchBegin;
+			uint32_t done = testSimd(frustum, spheres, batchCount, visible);
+			testScalar(frustum, spheres, done, batchCount, visible);
+			for (uint32_t i = 0; i < batchCount; i++) {
+				visibleObjects += visible[i];
+			}
+		}
+		return visibleObjects;
+	}
+
+	const char* getFrustumCullingBackendName() {
+#if defined(YELLOWSTONE_CULLING_AVX2)
+		return "avx2";
+#elif defined(YELLOWSTONE_CULLING_SSE2)
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "render_snapshot.hpp"
+#include "../yellowstone_thread_pool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	struct Frustum {
+		// World space planes with normals pointing inwards: left, right, bottom, top, near, far
+		glm::vec4 planes[6];
+
+		// Extracts the planes from a projection * view matrix with a 0..1 clip space depth range
+		static Frustum fromMatrix(const glm::mat4& projectionView);
+	};
+
+	struct FrustumCullingStats {
+		uint32_t testedObjects;
+		uint32_t visibleObjects;
+	};
+
+	// Tests every object of a snapshot against the view frustum using its model's bounding
+	// sphere. World space spheres are built a small batch of objects at a time and then
+	// tested against all six planes 8 at a time with AVX2 or 4 with SSE2. Large snapshots are
+	// split across the thread pool.
+	class FrustumCullingSystem {
+	public:
+		FrustumCullingSystem() = default;
+		FrustumCullingSystem(const FrustumCullingSystem&) = delete;
+		FrustumCullingSystem& operator=(const FrustumCullingSystem&) = delete;
+
+		void cull(const Frustum& frustum, const std::vector<RenderObject>& objects, YellowstoneThreadPool* threadPool = nullptr);
+
+		// One entry per object passed to the last cull(), nonzero if it may be visible
+		const std::vector<uint8_t>& getVisibility() const { return visibility; }
+		const FrustumCullingStats& getStats() const { return stats; }
+
+	private:
+		uint32_t cullRange(uint32_t begin, uint32_t end);
+
+		// Snapshots larger than this are split into pieces of at most this size and run in parallel
+		const uint32_t parallelChunkSize = 4096;
+
+		Frustum frustum{};
+		const RenderObject* objects = nullptr;
+		std::vector<uint8_t> visibility;
+
+		FrustumCullingStats stats{};
+	};
+
+	const char* getFrustumCullingBackendName();
+
+}
@@ -3,113 +3,464 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
 namespace yellowstone {
 
-	PhysicsSystem::PhysicsSystem() {}
+	PhysicsSystem::PhysicsSystem() {
+		setWorkerThreadCount(YellowstoneThreadPool::defaultWorkerCount());
+		contactSolver.setRestitution(bounceDamping);
+		contactSolver.setGroundY(groundY);
+	}
 
-	void PhysicsSystem::update(FrameInfo& frameInfo) {
-		float deltaTime = frameInfo.frameTime;
+	void PhysicsSystem::update(YellowstoneRegistry& registry, float deltaTime) {
+		syncBodies(registry);
+		step(deltaTime);
+		writeBack();
+	}
 
-		// Apply physics to all non-static objects
-		for (auto& kv : frameInfo.gameObjects) {
-			auto& obj = kv.second;
-			
-			// Skip static objects
-			if (obj.physics.isStatic) {
-				continue;
+	void PhysicsSystem::markBodiesDirty() {
+		bodiesDirty = true;
+	}
+
+	void PhysicsSystem::syncBodies(YellowstoneRegistry& registry) {
+		// The world owns body state between steps; it is only gathered from the registry
+		// again when components were changed from outside or entities were added or removed
+		if (!bodiesDirty && &registry == syncedRegistry && registry.getVersion() == syncedVersion) {
+			return;
+		}
+
+		// Every body starts awake again, so no sleeping body can be left resting on an entity
+		// that was removed
+		world.clear();
+		world.reserve(registry.size());
+		fellAsleep.clear();
+		restingContacts.clear();
+		bodyLookup.clear();
+		dynamicBounds.clear();
+		staticEntities.clear();
+		staticBounds.clear();
+
+		registry.each<TransformComponent, PhysicsComponent>(Without<StaticComponent>{}, [&](Entity entity, TransformComponent& transform, PhysicsComponent& physics) {
+			uint32_t body = world.addBody(entity, transform.translation, physics.velocity, transform.scale * 0.5f, physics.mass);
+			bodyLookup[entity] = body;
+			dynamicBounds.push_back(world.getBounds(world.getSlot(body)));
+		});
+
+		registry.each<TransformComponent, PhysicsComponent, StaticComponent>([&](Entity entity, TransformComponent& transform, PhysicsComponent&, StaticComponent&) {
+			staticEntities.push_back(entity);
+			staticBounds.push_back(computeAABB(transform));
+		});
+
+		// Every body can fall asleep in one step; reserving now keeps that off the heap
+		fellAsleep.reserve(world.size());
+		awakeCountAfterStep = world.getAwakeCount();
+
+		rebuildStaticTree();
+		broadphase->reset();
+		// Cached impulses are keyed by body index, which just changed
+		contactSolver.clearCache();
+		bodiesDirty = false;
+		syncedRegistry = &registry;
+		syncedVersion = registry.getVersion();
+	}
+
+	void PhysicsSystem::step(float deltaTime) {
+		// A fully settled scene has nothing to integrate and no contact that could change
+		if (world.getAwakeCount() == 0) {
+			islandStats = {};
+			solverStats = {};
+			stepStats = {};
+			return;
+		}
+
+		// Contacts are found at the positions the last step ended with and solved on this
+		// step's velocities, before those velocities move anything
+		IntegrationSettings integration{deltaTime, gravity, groundY, linearDamping};
+		integrateVelocities(world, integration);
+
+		// Sleeping bodies did not move, so only awake bounds are refreshed
+		movedBodies.clear();
+		for (uint32_t slot = 0; slot < world.getAwakeCount(); slot++) {
+			uint32_t body = world.bodies[slot];
+			dynamicBounds[body] = world.getBounds(slot);
+			movedBodies.push_back(body);
+		}
+
+		// Only narrowphase-test the candidate pairs reported by the broadphase
+		broadphase->update(dynamicBounds, movedBodies);
+		candidatePairs.clear();
+		broadphase->findPairs(candidatePairs);
+
+		// Keep the candidate pairs that touch and involve an awake body
+		float wakeSpeedSquared = sleepVelocity * sleepVelocity;
+		contacts.clear();
+		stepStats = {};
+		for (const auto& pair : candidatePairs) {
+			bool awake1 = world.isAwake(pair.first);
+			bool awake2 = world.isAwake(pair.second);
+			if (!awake1 && !awake2) continue;
+			stepStats.pairTests++;
+			if (!checkAABBCollision(pair.first, pair.second)) continue;
+
+			// Wake a sleeping body when it is hit harder than a resting contact
+			if (!awake1 || !awake2) {
+				uint32_t sleeping = awake1 ? pair.second : pair.first;
+				glm::vec3 hitVelocity = world.getVelocity(world.getSlot(awake1 ? pair.first : pair.second));
+				if (glm::dot(hitVelocity, hitVelocity) > wakeSpeedSquared) {
+					world.wake(sleeping);
+				}
 			}
+			contacts.push_back(pair);
+		}
+
+		// Awake bodies touching the ground plane get a ground contact so the solver can hold up
+		// what stands on them
+		for (uint32_t slot = 0; slot < world.getAwakeCount(); slot++) {
+			if (world.positionY[slot] + world.halfExtentY[slot] >= groundY) {
+				contacts.push_back({world.bodies[slot], PhysicsWorld::groundBody});
+			}
+		}
 
-			// Apply gravity
-			obj.physics.velocity.y += gravity * deltaTime;
+		wakeRestingNeighbours();
 
-			// Update position based on velocity
-			obj.transform.translation += obj.physics.velocity * deltaTime;
+		stepStats.contacts = static_cast<uint32_t>(contacts.size());
+		stepStats.awakeBodies = world.getAwakeCount();
 
-			// Check ground collision (accounting for object's bottom edge)
-			// In Y-down system: objects below ground (positive Y) collide
-			float bottomY = obj.transform.translation.y + obj.transform.scale.y * 0.5f;
-			if (bottomY >= groundY) {
-				resolveGroundCollision(obj);
+		contactIslands.build(world, contacts);
+		stepDeltaTime = deltaTime;
+		contactSolver.beginStep(contacts.size());
+		solveIslands();
+		contactSolver.endStep();
+
+		integratePositions(world, integration);
+
+		if (sleepingEnabled) {
+			updateSleepState(deltaTime);
+		}
+		awakeCountAfterStep = world.getAwakeCount();
+	}
+
+	void PhysicsSystem::wakeRestingNeighbours() {
+		// A resting contact can only change once one of its bodies wakes, and with none
+		// woken since the last step every body in the list is still asleep
+		if (world.getAwakeCount() == awakeCountAfterStep) {
+			return;
+		}
+
+		// Repeat until nothing else wakes, so a whole pile wakes in the same step as the body
+		// it stands on. Bodies woken here start moving next step.
+		bool woke = true;
+		while (woke) {
+			woke = false;
+			for (size_t i = 0; i < restingContacts.size();) {
+				BodyPair pair = restingContacts[i];
+				bool awake1 = world.isAwake(pair.first);
+				bool awake2 = world.isAwake(pair.second);
+				if (!awake1 && !awake2) {
+					i++;
+					continue;
+				}
+				if (!awake1 || !awake2) {
+					world.wake(awake1 ? pair.second : pair.first);
+					woke = true;
+				}
+				// Both bodies are awake now, so the pair is an ordinary contact again
+				restingContacts[i] = restingContacts.back();
+				restingContacts.pop_back();
+			}
+		}
+	}
+
+	void PhysicsSystem::solveIslands() {
+		auto& islands = contactIslands.getIslands();
+		solveOrder.clear();
+		for (uint32_t i = 0; i < islands.size(); i++) {
+			if (islands[i].contactCount > 0) {
+				solveOrder.push_back(i);
+			}
+		}
+
+		// Hand out the largest islands first so a big pile doesn't end up finishing last
+		std::sort(solveOrder.begin(), solveOrder.end(), [&](uint32_t a, uint32_t b) {
+			return islands[a].contactCount > islands[b].contactCount;
+		});
+
+		auto start = std::chrono::high_resolution_clock::now();
+		if (threadPool != nullptr && contacts.size() >= parallelContactThreshold) {
+			threadPool->parallelFor(static_cast<uint32_t>(solveOrder.size()), [this](uint32_t index) {
+				solveIsland(solveOrder[index]);
+			});
+		} else {
+			for (uint32_t island : solveOrder) {
+				solveIsland(island);
 			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
 
-			// Apply simple damping to prevent infinite bouncing
-			obj.physics.velocity *= 0.99f;
+		islandStats = {};
+		islandStats.islandCount = static_cast<uint32_t>(solveOrder.size());
+		islandStats.solveMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		solverStats = {};
+		solverStats.iterations = contactSolver.getIterations();
+		solverStats.contactCount = static_cast<uint32_t>(contacts.size());
+		for (uint32_t index : solveOrder) {
+			const Island& island = islands[index];
+			islandStats.largestIsland = std::max(islandStats.largestIsland, island.bodyCount);
+			islandStats.slowestIslandMilliseconds = std::max(islandStats.slowestIslandMilliseconds, island.solveMilliseconds);
+			solverStats.warmStartedContacts += island.warmStartedContacts;
+			solverStats.initialResidual += island.initialResidual;
+			solverStats.finalResidual += island.finalResidual;
 		}
+	}
+
+	void PhysicsSystem::solveIsland(uint32_t index) {
+		// Islands share no awake bodies, so they can be solved on any thread. Within an
+		// island contacts are solved in a fixed order, which keeps results deterministic.
+		Island& island = contactIslands.getIslands()[index];
+
+		auto start = std::chrono::high_resolution_clock::now();
+		SolverResidual residual = contactSolver.solve(world, contactIslands.getContacts(), island.contactBegin, island.contactCount, stepDeltaTime);
+		auto end = std::chrono::high_resolution_clock::now();
+		island.solveMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		island.initialResidual = residual.initial;
+		island.finalResidual = residual.final;
+		island.warmStartedContacts = residual.warmStarted;
+	}
+
+	void PhysicsSystem::setWorkerThreadCount(uint32_t count) {
+		ownedThreadPool = count > 0 ? std::make_unique<YellowstoneThreadPool>(count) : nullptr;
+		threadPool = ownedThreadPool.get();
+	}
 
-		// Check collisions between dynamic objects
-		for (auto it1 = frameInfo.gameObjects.begin(); it1 != frameInfo.gameObjects.end(); ++it1) {
-			auto& obj1 = it1->second;
-			if (obj1.physics.isStatic) continue;
+	void PhysicsSystem::setThreadPool(YellowstoneThreadPool* pool) {
+		ownedThreadPool.reset();
+		threadPool = pool;
+	}
+
+	void PhysicsSystem::setSolverIterations(uint32_t iterations) {
+		contactSolver.setIterations(iterations);
+	}
 
-			for (auto it2 = std::next(it1); it2 != frameInfo.gameObjects.end(); ++it2) {
-				auto& obj2 = it2->second;
-				if (obj2.physics.isStatic) continue;
+	void PhysicsSystem::updateSleepState(float deltaTime) {
+		float sleepSpeedSquared = sleepVelocity * sleepVelocity;
+		uint32_t awakeCount = world.getAwakeCount();
+		auto& islands = contactIslands.getIslands();
+		islandReady.assign(islands.size(), 1);
 
-				if (checkAABBCollision(obj1, obj2)) {
-					resolveCollision(obj1, obj2);
+		for (uint32_t slot = 0; slot < awakeCount; slot++) {
+			glm::vec3 velocity = world.getVelocity(slot);
+			if (glm::dot(velocity, velocity) > sleepSpeedSquared) {
+				world.sleepTimer[slot] = 0.0f;
+			} else {
+				world.sleepTimer[slot] += deltaTime;
+			}
+
+			// An island only goes to sleep once every body in it is ready to
+			if (world.sleepTimer[slot] < timeToSleep) {
+				islandReady[contactIslands.getIsland(world.bodies[slot])] = 0;
+			}
+		}
+
+		// Contacts of islands going to sleep are remembered, including those with bodies that
+		// were already asleep, so waking any of them later wakes the rest
+		const auto& islandContacts = contactIslands.getContacts();
+		for (uint32_t index = 0; index < islands.size(); index++) {
+			if (!islandReady[index]) continue;
+			const Island& island = islands[index];
+			for (uint32_t c = island.contactBegin; c < island.contactBegin + island.contactCount; c++) {
+				// The ground never wakes, so its contacts have nothing to pass on
+				if (islandContacts[c].second != PhysicsWorld::groundBody) {
+					restingContacts.push_back(islandContacts[c]);
 				}
 			}
 		}
+
+		for (uint32_t slot = 0; slot < world.getAwakeCount();) {
+			uint32_t body = world.bodies[slot];
+			if (!islandReady[contactIslands.getIsland(body)]) {
+				slot++;
+				continue;
+			}
+
+			// sleep() moves the last awake body into this slot, so don't advance
+			world.sleep(body);
+			fellAsleep.push_back(body);
+		}
+	}
+
+	void PhysicsSystem::writeBack() {
+		// Sleeping bodies don't move, so they are only written once when they fall asleep
+		for (uint32_t slot = 0; slot < world.getAwakeCount(); slot++) {
+			writeBackBody(world.bodies[slot]);
+		}
+		for (uint32_t body : fellAsleep) {
+			if (!world.isAwake(body)) writeBackBody(body);
+		}
+		fellAsleep.clear();
+	}
+
+	void PhysicsSystem::copyBodyStates(std::vector<Entity>& entities, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& velocities) const {
+		entities.assign(world.ids.begin(), world.ids.end());
+		positions.resize(world.size());
+		velocities.resize(world.size());
+		for (uint32_t body = 0; body < world.size(); body++) {
+			uint32_t slot = world.getSlot(body);
+			positions[body] = world.getPosition(slot);
+			velocities[body] = world.getVelocity(slot);
+		}
+	}
+
+	void PhysicsSystem::writeBackBody(uint32_t body) {
+		Entity entity = world.ids[body];
+		auto* transform = syncedRegistry->get<TransformComponent>(entity);
+		auto* physics = syncedRegistry->get<PhysicsComponent>(entity);
+		if (transform == nullptr || physics == nullptr) {
+			return;
+		}
+		uint32_t slot = world.getSlot(body);
+		transform->translation = world.getPosition(slot);
+		physics->velocity = world.getVelocity(slot);
 	}
 
-	bool PhysicsSystem::checkAABBCollision(const YellowstoneGameObject& obj1, const YellowstoneGameObject& obj2) {
-		// Simple AABB collision detection
-		// Using scale as half-extents (assuming objects are centered)
-		glm::vec3 min1 = obj1.transform.translation - obj1.transform.scale * 0.5f;
-		glm::vec3 max1 = obj1.transform.translation + obj1.transform.scale * 0.5f;
-		glm::vec3 min2 = obj2.transform.translation - obj2.transform.scale * 0.5f;
-		glm::vec3 max2 = obj2.transform.translation + obj2.transform.scale * 0.5f;
-
-		return (min1.x <= max2.x && max1.x >= min2.x) &&
-		       (min1.y <= max2.y && max1.y >= min2.y) &&
-		       (min1.z <= max2.z && max1.z >= min2.z);
-	}
-
-	void PhysicsSystem::resolveCollision(YellowstoneGameObject& obj1, YellowstoneGameObject& obj2) {
-		// Simple collision response: separate objects and reverse velocities
-		glm::vec3 collisionNormal = glm::normalize(obj1.transform.translation - obj2.transform.translation);
-		
-		// Separate objects to prevent overlap
-		float overlap = glm::length(obj1.transform.scale + obj2.transform.scale) * 0.5f - 
-		                glm::length(obj1.transform.translation - obj2.transform.translation);
-		if (overlap > 0.0f) {
-			obj1.transform.translation += collisionNormal * overlap * 0.5f;
-			obj2.transform.translation -= collisionNormal * overlap * 0.5f;
-		}
-
-		// Simple velocity exchange with damping
-		glm::vec3 relativeVelocity = obj1.physics.velocity - obj2.physics.velocity;
-		float velocityAlongNormal = glm::dot(relativeVelocity, collisionNormal);
-
-		// Don't resolve if velocities are separating
-		if (velocityAlongNormal > 0) return;
-
-		// Calculate impulse
-		float restitution = bounceDamping;
-		float j = -(1 + restitution) * velocityAlongNormal;
-		j /= (1.0f / obj1.physics.mass + 1.0f / obj2.physics.mass);
-
-		glm::vec3 impulse = j * collisionNormal;
-		obj1.physics.velocity += impulse / obj1.physics.mass;
-		obj2.physics.velocity -= impulse / obj2.physics.mass;
-	}
-
-	void PhysicsSystem::resolveGroundCollision(YellowstoneGameObject& obj) {
-		// Place object on ground (in Y-down system, ground is at Y=0, so object center is above)
-		obj.transform.translation.y = groundY - obj.transform.scale.y * 0.5f;
-		
-		// Bounce if falling down (positive Y velocity in Y-down system)
-		if (obj.physics.velocity.y > 0.0f) {
-			obj.physics.velocity.y *= -bounceDamping;
-			
-			// Stop if velocity is too small
-			if (std::abs(obj.physics.velocity.y) < 0.1f) {
-				obj.physics.velocity.y = 0.0f;
+	void PhysicsSystem::setSleepingEnabled(bool enabled) {
+		sleepingEnabled = enabled;
+		if (!enabled) {
+			for (uint32_t body = 0; body < world.size(); body++) {
+				world.wake(body);
 			}
+			restingContacts.clear();
 		}
 	}
 
-}
+	void PhysicsSystem::setSleepThresholds(float velocity, float time) {
+		sleepVelocity = velocity;
+		timeToSleep = time;
+	}
+
+	void PhysicsSystem::wakeBody(Entity entity) {
+		auto it = bodyLookup.find(entity);
+		if (it != bodyLookup.end()) {
+			world.wake(it->second);
+		}
+	}
+
+	void PhysicsSystem::setBodyVelocity(Entity entity, const glm::vec3& velocity) {
+		auto it = bodyLookup.find(entity);
+		if (it == bodyLookup.end()) {
+			return;
+		}
+		world.wake(it->second);
+		world.setVelocity(world.getSlot(it->second), velocity);
+	}
+
+	void PhysicsSystem::applyImpulse(Entity entity, const glm::vec3& impulse) {
+		auto it = bodyLookup.find(entity);
+		if (it == bodyLookup.end()) {
+			return;
+		}
+		world.wake(it->second);
+		uint32_t slot = world.getSlot(it->second);
+		world.setVelocity(slot, world.getVelocity(slot) + impulse * world.inverseMass[slot]);
+	}
+
+	void PhysicsSystem::setBroadphase(BroadphaseType type) {
+		switch (type) {
+			case BroadphaseType::SpatialHash:
+				broadphase = &spatialHashGrid;
+				break;
+			case BroadphaseType::SweepAndPrune:
+				broadphase = &sweepAndPrune;
+				break;
+			case BroadphaseType::AABBTree:
+				broadphase = &aabbTree;
+				break;
+		}
+		broadphaseType = type;
+		broadphase->reset();
+	}
+
+	void PhysicsSystem::setBroadphaseCellSize(float cellSize) {
+		spatialHashGrid.setCellSize(cellSize);
+	}
+
+	void PhysicsSystem::setFatAABBMargin(float margin) {
+		aabbTree.setFatMargin(margin);
+		aabbTree.reset();
+	}
+
+	void PhysicsSystem::rebuildStaticTree() {
+		staticTree.clear();
+		staticProxies.clear();
+		for (uint32_t i = 0; i < staticBounds.size(); i++) {
+			staticProxies.push_back(staticTree.createProxy(staticBounds[i], i));
+		}
+	}
+
+	void PhysicsSystem::queryAABB(const AABB& box, std::vector<Entity>& results) const {
+		staticTree.query(box, [&](uint32_t index) {
+			if (staticBounds[index].overlaps(box)) results.push_back(staticEntities[index]);
+			return true;
+		});
+
+		auto visitDynamic = [&](uint32_t index) {
+			if (dynamicBounds[index].overlaps(box)) results.push_back(world.ids[index]);
+			return true;
+		};
+		if (broadphase == &aabbTree) {
+			aabbTree.getTree().query(box, visitDynamic);
+		} else {
+			for (uint32_t i = 0; i < dynamicBounds.size(); i++) {
+				visitDynamic(i);
+			}
+		}
+	}
 
+	bool PhysicsSystem::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RaycastHit& hit) const {
+		glm::vec3 inverseDirection = 1.0f / direction;
+		bool found = false;
+
+		// Test the tight box of each candidate and clip the ray at the closest hit so far
+		auto testBox = [&](const AABB& box, Entity entity, float currentMax) {
+			float distance;
+			if (box.raycast(origin, inverseDirection, currentMax, distance)) {
+				hit = {entity, distance};
+				found = true;
+				return distance;
+			}
+			return currentMax;
+		};
+
+		float closest = maxDistance;
+		staticTree.raycast(origin, direction, closest, [&](uint32_t index, float currentMax) {
+			closest = testBox(staticBounds[index], staticEntities[index], currentMax);
+			return closest;
+		});
+
+		if (broadphase == &aabbTree) {
+			aabbTree.getTree().raycast(origin, direction, closest, [&](uint32_t index, float currentMax) {
+				return testBox(dynamicBounds[index], world.ids[index], currentMax);
+			});
+		} else {
+			for (uint32_t i = 0; i < dynamicBounds.size(); i++) {
+				closest = testBox(dynamicBounds[i], world.ids[i], closest);
+			}
+		}
+
+		return found;
+	}
+
+	AABB PhysicsSystem::computeAABB(const TransformComponent& transform) {
+		glm::vec3 halfExtents = transform.scale * 0.5f;
+		return {transform.translation - halfExtents, transform.translation + halfExtents};
+	}
+
+	bool PhysicsSystem::checkAABBCollision(uint32_t body1, uint32_t body2) {
+		// Simple AABB collision detection against the current positions
+		return world.getBounds(world.getSlot(body1)).overlaps(world.getBounds(world.getSlot(body2)));
+	}
+
+}
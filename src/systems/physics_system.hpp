@@ -1,10 +1,54 @@
 #pragma once
 
-#include "../yellowstone_frame_info.hpp"
-#include "../yellowstone_game_object.hpp"
+#include "../ecs/components.hpp"
+#include "../ecs/registry.hpp"
+#include "../yellowstone_thread_pool.hpp"
+#include "../physics/aabb_tree_broadphase.hpp"
+#include "../physics/contact_islands.hpp"
+#include "../physics/contact_solver.hpp"
+#include "../physics/physics_integrator.hpp"
+#include "../physics/physics_world.hpp"
+#include "../physics/spatial_hash_grid.hpp"
+#include "../physics/sweep_and_prune.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace yellowstone {
 
+	struct RaycastHit {
+		Entity entity;
+		float distance;
+	};
+
+	struct IslandStats {
+		// Islands that had at least one contact to solve
+		uint32_t islandCount;
+		uint32_t largestIsland;
+		float solveMilliseconds;
+		float slowestIslandMilliseconds;
+	};
+
+	struct StepStats {
+		// Broadphase candidate pairs with an awake body, each tested for overlap
+		uint32_t pairTests;
+		// Pairs that touched and were handed to the solver
+		uint32_t contacts;
+		uint32_t awakeBodies;
+	};
+
+	struct SolverStats {
+		uint32_t iterations;
+		uint32_t contactCount;
+		// Contacts that started from last step's accumulated impulse
+		uint32_t warmStartedContacts;
+		// Summed impulse change over all contacts in the first and last iteration;
+		// a final residual close to zero means the solver converged
+		float initialResidual;
+		float finalResidual;
+	};
+
 	class PhysicsSystem {
 	public:
 		PhysicsSystem();
@@ -12,16 +56,120 @@ namespace yellowstone {
 		PhysicsSystem(const PhysicsSystem&) = delete;
 		PhysicsSystem& operator=(const PhysicsSystem&) = delete;
 
-		void update(FrameInfo& frameInfo);
+		// Syncs, steps and writes results back to the entities in one call
+		void update(YellowstoneRegistry& registry, float deltaTime);
+		// Call after changing transforms or velocities outside of the physics system
+		void markBodiesDirty();
+
+		// The pieces of update() for callers that step physics away from the registry,
+		// e.g. on another thread. step() only touches the physics world.
+		void syncBodies(YellowstoneRegistry& registry);
+		void step(float deltaTime);
+		void writeBack();
+		// Per-body entity and state after the last step
+		void copyBodyStates(std::vector<Entity>& entities, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& velocities) const;
+		size_t getBodyCount() const { return world.size(); }
+
+		// Bodies slower than 'velocity' for 'time' seconds are put to sleep and skipped
+		// until something hits them, they are changed through the functions below, or a body
+		// they were resting against wakes up. Adding or removing entities resyncs and wakes
+		// every body, so nothing is left resting on a body that is gone.
+		void setSleepingEnabled(bool enabled);
+		void setSleepThresholds(float velocity, float time);
+		uint32_t getAwakeBodyCount() const { return world.getAwakeCount(); }
+		uint32_t getSleepingBodyCount() const { return world.getSleepingCount(); }
+
+		// Islands of touching bodies are solved in parallel; 0 workers solves everything inline
+		void setWorkerThreadCount(uint32_t count);
+		// Solves islands on a job system owned by the caller instead, e.g. the one shared with
+		// the rest of the engine. It must outlive this system or be replaced first.
+		void setThreadPool(YellowstoneThreadPool* pool);
+		const IslandStats& getIslandStats() const { return islandStats; }
+		const std::vector<Island>& getIslands() const { return contactIslands.getIslands(); }
+
+		void setSolverIterations(uint32_t iterations);
+		const SolverStats& getSolverStats() const { return solverStats; }
+		const StepStats& getStepStats() const { return stepStats; }
+
+		void wakeBody(Entity entity);
+		void setBodyVelocity(Entity entity, const glm::vec3& velocity);
+		void applyImpulse(Entity entity, const glm::vec3& impulse);
+
+		void setBroadphase(BroadphaseType type);
+		BroadphaseType getBroadphaseType() const { return broadphaseType; }
+		void setBroadphaseCellSize(float cellSize);
+		void setFatAABBMargin(float margin);
+
+		// Scene queries against the bounds from the last update, static objects included
+		void queryAABB(const AABB& box, std::vector<Entity>& results) const;
+		bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RaycastHit& hit) const;
 
 	private:
 		const float gravity = 9.8f; // Positive gravity pulls downward (Y-down coordinate system)
-		const float bounceDamping = 0.7f; // Energy loss on bounce
+		const float bounceDamping = 0.7f; // Restitution of contacts that hit hard enough to bounce
 		const float groundY = 0.0f; // Ground plane Y position
+		const float linearDamping = 0.99f; // Per-step velocity damping
+
+		void solveIslands();
+		void solveIsland(uint32_t index);
+		void updateSleepState(float deltaTime);
+		void wakeRestingNeighbours();
+		void writeBackBody(uint32_t body);
+
+		static AABB computeAABB(const TransformComponent& transform);
+		bool checkAABBCollision(uint32_t body1, uint32_t body2);
+		void rebuildStaticTree();
+
+		bool sleepingEnabled = true;
+		float sleepVelocity = 0.25f;
+		float timeToSleep = 0.5f;
+
+		PhysicsWorld world;
+		// Bodies write back to the registry they were synced from; world.ids holds each
+		// body's entity
+		YellowstoneRegistry* syncedRegistry = nullptr;
+		uint64_t syncedVersion = 0;
+		std::unordered_map<Entity, uint32_t> bodyLookup;
+		bool bodiesDirty = true;
+
+		SpatialHashGrid spatialHashGrid{1.0f};
+		SweepAndPrune sweepAndPrune;
+		AABBTreeBroadphase aabbTree{0.1f};
+		Broadphase* broadphase = &aabbTree;
+		BroadphaseType broadphaseType = BroadphaseType::AABBTree;
+
+		// Static objects never take part in pair generation, but scene queries still see them
+		DynamicAABBTree staticTree{0.0f};
+		std::vector<int32_t> staticProxies;
+		std::vector<Entity> staticEntities;
+		std::vector<AABB> staticBounds;
+
+		// Indexed by body; sleeping bodies keep their last bounds
+		std::vector<AABB> dynamicBounds;
+		std::vector<uint32_t> movedBodies;
+		// Bodies that fell asleep since the last writeBack()
+		std::vector<uint32_t> fellAsleep;
+		// Contacts that were touching when one of their bodies fell asleep. Once either body
+		// is awake again the other is woken too, since whatever it rested on may move away.
+		std::vector<BodyPair> restingContacts;
+		// Awake bodies when the last step ended; any wake since then raises the count
+		uint32_t awakeCountAfterStep = 0;
+		std::vector<BodyPair> candidatePairs;
+		std::vector<BodyPair> contacts;
+
+		// Below this many contacts, handing islands to other threads costs more than it saves
+		const size_t parallelContactThreshold = 256;
+		std::unique_ptr<YellowstoneThreadPool> ownedThreadPool;
+		YellowstoneThreadPool* threadPool = nullptr;
+		ContactIslands contactIslands;
+		std::vector<uint32_t> solveOrder;
+		std::vector<uint8_t> islandReady;
+		IslandStats islandStats{};
 
-		bool checkAABBCollision(const YellowstoneGameObject& obj1, const YellowstoneGameObject& obj2);
-		void resolveCollision(YellowstoneGameObject& obj1, YellowstoneGameObject& obj2);
-		void resolveGroundCollision(YellowstoneGameObject& obj);
+		ContactSolver contactSolver;
+		SolverStats solverStats{};
+		StepStats stepStats{};
+		float stepDeltaTime = 0.0f;
 	};
 
 }
@@ -0,0 +1,121 @@
+#include "physics_thread.hpp"
+#include "../yellowstone_frame_arena.hpp"
+#include "../yellowstone_allocation_tracker.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace yellowstone {
+
+	PhysicsThread::PhysicsThread(PhysicsSystem& physicsSystem, float stepRate) : physicsSystem{physicsSystem} {
+		setStepRate(stepRate);
+	}
+
+	PhysicsThread::~PhysicsThread() {
+		stop();
+	}
+
+	void PhysicsThread::setStepRate(float stepRate) {
+		assert(stepRate > 0.0f && "Physics step rate must be positive");
+		stepDuration = 1.0f / stepRate;
+	}
+
+	void PhysicsThread::start(YellowstoneRegistry& registry) {
+		assert(!running && "Physics thread is already running");
+		startTime = Clock::now();
+		reset(registry);
+		running = true;
+		thread = std::thread(&PhysicsThread::run, this);
+	}
+
+	void PhysicsThread::stop() {
+		if (!running) {
+			return;
+		}
+		running = false;
+		thread.join();
+	}
+
+	void PhysicsThread::reset(YellowstoneRegistry& registry) {
+		std::lock_guard<std::mutex> lock{simulationMutex};
+		physicsSystem.markBodiesDirty();
+		physicsSystem.syncBodies(registry);
+		// Don't interpolate from positions the entities were just moved away from
+		physicsSystem.copyBodyStates(snapshots[writeIndex].entities, previousPositions, snapshots[writeIndex].velocities);
+		publish(secondsSinceStart(Clock::now()), stepDuration);
+	}
+
+	double PhysicsThread::secondsSinceStart(Clock::time_point time) const {
+		return std::chrono::duration<double>(time - startTime).count();
+	}
+
+	void PhysicsThread::run() {
+		auto nextStep = Clock::now();
+		while (running) {
+			std::this_thread::sleep_until(nextStep);
+
+			float duration = stepDuration;
+			auto stepLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(duration));
+			{
+				std::lock_guard<std::mutex> lock{simulationMutex};
+				auto start = Clock::now();
+				AllocationScope allocationScope{"physics"};
+				YellowstoneFrameArena::beginFrame(static_cast<uint32_t>(stepCount.load()));
+				physicsSystem.step(duration);
+				lastStepMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+				nextStep += stepLength;
+				publish(secondsSinceStart(nextStep), duration);
+			}
+			stepCount++;
+
+			auto now = Clock::now();
+			if (now - nextStep > stepLength * maxCatchUpSteps) {
+				nextStep = now;
+			}
+		}
+	}
+
+	void PhysicsThread::publish(double time, float duration) {
+		TransformSnapshot& snapshot = snapshots[writeIndex];
+		snapshot.previousPositions.swap(previousPositions);
+		physicsSystem.copyBodyStates(snapshot.entities, snapshot.positions, snapshot.velocities);
+		snapshot.stepIndex = stepCount;
+		snapshot.time = time;
+		snapshot.stepDuration = duration;
+		// The next step interpolates from where this one ended
+		previousPositions.assign(snapshot.positions.begin(), snapshot.positions.end());
+
+		writeIndex = latest.exchange(writeIndex | freshBit) & ~freshBit;
+	}
+
+	void PhysicsThread::interpolate(YellowstoneRegistry& registry) {
+		if (latest.load() & freshBit) {
+			readIndex = latest.exchange(readIndex) & ~freshBit;
+		}
+
+		const TransformSnapshot& snapshot = snapshots[readIndex];
+		if (snapshot.entities.empty() || snapshot.previousPositions.size() != snapshot.positions.size()) {
+			return;
+		}
+
+		// Render one step behind the simulation so there are always two states to blend
+		double renderTime = secondsSinceStart(Clock::now()) - snapshot.stepDuration;
+		double previousTime = snapshot.time - snapshot.stepDuration;
+		float alpha = static_cast<float>((renderTime - previousTime) / snapshot.stepDuration);
+		alpha = std::max(0.0f, std::min(alpha, 1.0f));
+
+		// Entities destroyed since the snapshot was taken no longer resolve and are skipped
+		for (size_t body = 0; body < snapshot.entities.size(); body++) {
+			auto* transform = registry.get<TransformComponent>(snapshot.entities[body]);
+			auto* physics = registry.get<PhysicsComponent>(snapshot.entities[body]);
+			if (transform == nullptr || physics == nullptr) continue;
+			// Written so a body that didn't move gets exactly the same position, which keeps
+			// its cached matrices valid
+			glm::vec3 previous = snapshot.previousPositions[body];
+			transform->translation = previous + (snapshot.positions[body] - previous) * alpha;
+			physics->velocity = snapshot.velocities[body];
+		}
+	}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "physics_system.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace yellowstone {
+
+	// Body state before and after one fixed step, published by the physics thread
+	struct TransformSnapshot {
+		uint64_t stepIndex = 0;
+		// Seconds since the physics thread started at which 'positions' is valid
+		double time = 0.0;
+		float stepDuration = 0.0f;
+		std::vector<Entity> entities;
+		std::vector<glm::vec3> previousPositions;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> velocities;
+	};
+
+	// Steps a PhysicsSystem at a fixed rate on its own thread. Each step is published into a
+	// triple buffer, so the render thread always picks up the latest complete snapshot without
+	// waiting, and draws positions interpolated between the last two steps. The registry is
+	// only ever touched by interpolate() and reset(), which must not run at the same time.
+	class PhysicsThread {
+	public:
+		PhysicsThread(PhysicsSystem& physicsSystem, float stepRate = 120.0f);
+		~PhysicsThread();
+		PhysicsThread(const PhysicsThread&) = delete;
+		PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+		void start(YellowstoneRegistry& registry);
+		void stop();
+		bool isRunning() const { return running; }
+
+		// Steps per second, can be changed while running
+		void setStepRate(float stepRate);
+		float getStepRate() const { return 1.0f / stepDuration; }
+
+		// Reloads bodies after entities were changed from outside. Waits for the step in
+		// progress, if any.
+		void reset(YellowstoneRegistry& registry);
+
+		// Writes the latest published state into the entities, with positions
+		// interpolated for the current time. Never blocks on the physics thread.
+		void interpolate(YellowstoneRegistry& registry);
+
+		uint64_t getStepCount() const { return stepCount; }
+		float getLastStepMilliseconds() const { return lastStepMilliseconds; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		void run();
+		void publish(double time, float duration);
+		double secondsSinceStart(Clock::time_point time) const;
+
+		// A frame that falls further behind than this drops the missed steps instead of
+		// trying to catch up, so a slow step can't snowball
+		const uint32_t maxCatchUpSteps = 4;
+
+		PhysicsSystem& physicsSystem;
+		std::thread thread;
+		std::atomic<bool> running{false};
+		std::atomic<float> stepDuration;
+		std::atomic<uint64_t> stepCount{0};
+		std::atomic<float> lastStepMilliseconds{0.0f};
+		Clock::time_point startTime;
+
+		// Held for the duration of a step and while reloading bodies
+		std::mutex simulationMutex;
+
+		// Triple buffer: the writer owns one snapshot, the reader another, and the third is
+		// the latest published one. 'latest' holds its index plus a bit set while unread.
+		static constexpr uint32_t freshBit = 4;
+		TransformSnapshot snapshots[3];
+		std::atomic<uint32_t> latest{1};
+		uint32_t writeIndex = 0;
+		uint32_t readIndex = 2;
+		std::vector<glm::vec3> previousPositions;
+	};
+
+}
@@ -71,5 +71,6 @@ namespace yellowstone {
 			);
 
 		vkCmdDraw(frameInfo.commandBuffer, 6, 1, 0, 0);
+		renderStats = RenderStats{1, 1, 0, 1};
 	}
 }
\ No newline at end of file
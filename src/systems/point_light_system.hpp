@@ -3,6 +3,7 @@
 #include "../yellowstone_pipeline.hpp"
 #include "../yellowstone_device.hpp"
 #include "../yellowstone_frame_info.hpp"
+#include "../yellowstone_render_queue.hpp"
 
 #include <memory>
 #include <vector>
@@ -18,6 +19,9 @@ namespace yellowstone {
 
         void render(FrameInfo& frameInfo);
 
+        // Binds and draws recorded by the last render()
+        const RenderStats& getRenderStats() const { return renderStats; }
+
     private:
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
         void createPipeline(VkRenderPass renderPass);
@@ -25,5 +29,6 @@ namespace yellowstone {
         YellowstoneDevice& yellowstoneDevice;
         std::unique_ptr<YellowstonePipeline> yellowstonePipeline;
         VkPipelineLayout pipelineLayout;
+        RenderStats renderStats{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "render_snapshot.hpp"
+
+namespace yellowstone {
+
+	void captureRenderObjects(YellowstoneRegistry& registry, RenderSnapshot& snapshot) {
+		snapshot.objects.clear();
+		snapshot.matrixUpdateCount = 0;
+		registry.each<TransformComponent, MeshComponent>(Without<HierarchyComponent>{}, [&](Entity, TransformComponent& transform, MeshComponent& mesh) {
+			if (transform.updateMatrices()) {
+				snapshot.matrixUpdateCount++;
+			}
+			snapshot.objects.push_back({mesh.model.get(), {transform.mat4(), glm::mat4{transform.normalMatrix()}}, mesh.color});
+		});
+		// World matrices of hierarchy nodes are kept up to date by TransformHierarchySystem
+		registry.each<HierarchyComponent, MeshComponent>([&](Entity, HierarchyComponent& hierarchy, MeshComponent& mesh) {
+			snapshot.objects.push_back({mesh.model.get(), {hierarchy.worldMatrix, glm::mat4{hierarchy.worldNormalMatrix}}, mesh.color});
+		});
+	}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../ecs/components.hpp"
+#include "../ecs/registry.hpp"
+#include "../ecs/transform_batch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	class YellowstoneModel;
+
+	struct RenderObject {
+		// Owned by the entity's MeshComponent; models are never unloaded while frames are in flight
+		YellowstoneModel* model;
+		TransformMatrices matrices;
+		glm::vec3 color;
+	};
+
+	// What the render stage needs from one simulated frame, copied out of the registry so the
+	// simulation can move on to the next frame while this one is recorded. Read-only once
+	// handed over.
+	struct RenderSnapshot {
+		uint64_t frameNumber = 0;
+		std::chrono::steady_clock::time_point simulationStart{};
+		float simulationMilliseconds = 0.0f;
+		// Transforms whose cached matrices had to be rebuilt for this frame
+		uint32_t matrixUpdateCount = 0;
+		std::vector<RenderObject> objects;
+	};
+
+	// Scheduler stand-in for the snapshot being filled or recorded from
+	struct RenderSnapshotResource {};
+
+	// Replaces snapshot.objects with every entity that has a mesh, using world matrices for
+	// entities in a transform hierarchy
+	void captureRenderObjects(YellowstoneRegistry& registry, RenderSnapshot& snapshot);
+
+}
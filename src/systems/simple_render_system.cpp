@@ -1,4 +1,5 @@
 #include "simple_render_system.hpp"
+#include "../yellowstone_swap_chain.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -9,31 +10,58 @@
 
 #include <stdexcept>
 #include <cassert>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
 
 namespace yellowstone {
 
-	struct SimplePushConstantData {
-		glm::mat4 modelMatrix{ 1.0f };
-		glm::mat4 normalMatrix{ 1.0f };
-	};
+	static_assert(sizeof(InstanceData) == 160, "InstanceData must match the std430 Instance struct in simple_shader.vert and cull.comp");
+	static_assert(sizeof(CullBatchData) == 32, "CullBatchData must match the std430 Batch struct in cull.comp");
 
 	SimpleRenderSystem::SimpleRenderSystem(YellowstoneDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : yellowstoneDevice{device} {
-		createPipelineLayout(globalSetLayout);
-		createPipeline(renderPass);
+		createCullDescriptors();
+		createPipelineLayouts(globalSetLayout);
+		createPipelines(renderPass);
 	}
 
 	SimpleRenderSystem::~SimpleRenderSystem() {
 		vkDestroyPipelineLayout(yellowstoneDevice.device(), pipelineLayout, nullptr);
+		vkDestroyPipelineLayout(yellowstoneDevice.device(), cullPipelineLayout, nullptr);
 	}
 
-	void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+	void SimpleRenderSystem::createCullDescriptors() {
+		cullPool = YellowstoneDescriptorPool::Builder(yellowstoneDevice)
+			.setMaxSets(YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.build();
+		// The instance and visible instance buffers are also read when drawing
+		cullSetLayout = YellowstoneDescriptorSetLayout::Builder(yellowstoneDevice)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.build();
+
+		frames.resize(YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (int i = 0; i < YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			reserveInstances(i, INITIAL_INSTANCE_CAPACITY);
+			reserveBatches(i, INITIAL_BATCH_CAPACITY);
+		}
+	}
+
+	void SimpleRenderSystem::createPipelineLayouts(VkDescriptorSetLayout globalSetLayout) {
+		// Set 0 is the global UBO, set 1 the frame's culling buffers
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout, cullSetLayout->getDescriptorSetLayout()};
+
+		// Where the draw's range starts in the visible instance buffer. Passed this way
+		// rather than as the command's firstInstance, which needs drawIndirectFirstInstance.
 		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(SimplePushConstantData);
-
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout};
+		pushConstantRange.size = sizeof(uint32_t);
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -44,9 +72,25 @@ namespace yellowstone {
 		if (vkCreatePipelineLayout(yellowstoneDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
 		}
+
+		VkDescriptorSetLayout cullSetLayoutHandle = cullSetLayout->getDescriptorSetLayout();
+		VkPushConstantRange cullPushConstantRange{};
+		cullPushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		cullPushConstantRange.offset = 0;
+		cullPushConstantRange.size = sizeof(CullPushConstantData);
+
+		VkPipelineLayoutCreateInfo cullPipelineLayoutInfo{};
+		cullPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		cullPipelineLayoutInfo.setLayoutCount = 1;
+		cullPipelineLayoutInfo.pSetLayouts = &cullSetLayoutHandle;
+		cullPipelineLayoutInfo.pushConstantRangeCount = 1;
+		cullPipelineLayoutInfo.pPushConstantRanges = &cullPushConstantRange;
+		if (vkCreatePipelineLayout(yellowstoneDevice.device(), &cullPipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create cull pipeline layout!");
+		}
 	}
 
-	void SimpleRenderSystem::createPipeline(VkRenderPass renderPass) {
+	void SimpleRenderSystem::createPipelines(VkRenderPass renderPass) {
 		assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
 		PipelineConfigInfo pipelineConfig{};
@@ -59,40 +103,313 @@ namespace yellowstone {
 			"../src/shaders/simple_shader.frag.spv",
 			pipelineConfig
 		);
+		cullPipeline = std::make_unique<YellowstoneComputePipeline>(
+			yellowstoneDevice,
+			"../src/shaders/cull.comp.spv",
+			cullPipelineLayout
+		);
 	}
 
-	void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
-		yellowstonePipeline->bind(frameInfo.commandBuffer);
+	void SimpleRenderSystem::reserveInstances(int frameIndex, uint32_t count) {
+		FrameResources& resources = frames[frameIndex];
+		if (resources.instances != nullptr && resources.instances->getInstanceCount() >= count) {
+			return;
+		}
 
+		uint32_t capacity = resources.instances != nullptr ? resources.instances->getInstanceCount() : INITIAL_INSTANCE_CAPACITY;
+		while (capacity < count) {
+			capacity *= 2;
+		}
+		// The frame's fence has been waited on, so the GPU is done with the old buffers and set
+		resources.instances = std::make_unique<YellowstoneBuffer>(
+			yellowstoneDevice,
+			sizeof(InstanceData),
+			capacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		resources.instances->map();
+		resources.visibleInstances = std::make_unique<YellowstoneBuffer>(
+			yellowstoneDevice,
+			sizeof(uint32_t),
+			capacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		writeDescriptorSet(frameIndex);
+	}
+
+	void SimpleRenderSystem::reserveBatches(int frameIndex, uint32_t count) {
+		FrameResources& resources = frames[frameIndex];
+		if (resources.batches != nullptr && resources.batches->getInstanceCount() >= count) {
+			return;
+		}
+
+		uint32_t capacity = resources.batches != nullptr ? resources.batches->getInstanceCount() : INITIAL_BATCH_CAPACITY;
+		while (capacity < count) {
+			capacity *= 2;
+		}
+		// Reset by the CPU before every culling pass, so these stay host visible
+		resources.batches = std::make_unique<YellowstoneBuffer>(
+			yellowstoneDevice,
+			sizeof(CullBatchData),
+			capacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		resources.batches->map();
+		resources.drawCommands = std::make_unique<YellowstoneBuffer>(
+			yellowstoneDevice,
+			sizeof(VkDrawIndexedIndirectCommand),
+			capacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		resources.drawCommands->map();
+		writeDescriptorSet(frameIndex);
+	}
+
+	void SimpleRenderSystem::writeDescriptorSet(int frameIndex) {
+		FrameResources& resources = frames[frameIndex];
+		// Called while the buffers are first created, before all of them exist
+		if (resources.instances == nullptr || resources.batches == nullptr) {
+			return;
+		}
+
+		auto instanceInfo = resources.instances->descriptorInfo();
+		auto visibleInfo = resources.visibleInstances->descriptorInfo();
+		auto batchInfo = resources.batches->descriptorInfo();
+		auto commandInfo = resources.drawCommands->descriptorInfo();
+		YellowstoneDescriptorWriter writer{*cullSetLayout, *cullPool};
+		writer.writeBuffer(0, &instanceInfo)
+			.writeBuffer(1, &visibleInfo)
+			.writeBuffer(2, &batchInfo)
+			.writeBuffer(3, &commandInfo);
+		if (resources.descriptorSet == VK_NULL_HANDLE) {
+			if (!writer.build(resources.descriptorSet)) {
+				throw std::runtime_error("failed to allocate cull descriptor set!");
+			}
+		} else {
+			writer.overwrite(resources.descriptorSet);
+		}
+	}
+
+	uint32_t SimpleRenderSystem::findBatch(YellowstoneModel* model) {
+		// Scenes have few distinct models, so a linear search beats hashing
+		for (uint32_t i = 0; i < batches.size(); i++) {
+			if (batches[i].model == model) {
+				return i;
+			}
+		}
+		batches.push_back({model, 0, 0});
+		return static_cast<uint32_t>(batches.size() - 1);
+	}
+
+	void SimpleRenderSystem::cullGameObjects(FrameInfo& frameInfo, YellowstoneThreadPool* threadPool) {
+		const std::vector<RenderObject>& objects = frameInfo.snapshot.objects;
+		FrameResources& resources = frames[frameInfo.frameIndex];
+		Frustum frustum = Frustum::fromMatrix(frameInfo.camera.getProjectionMatrix() * frameInfo.camera.getViewMatrix());
+		// Without CPU culling every object is uploaded and the culling pass tests them all
+		bool cpuCulling = !gpuFrustumCulling;
+		if (cpuCulling) {
+			frustumCulling.cull(frustum, objects, threadPool);
+			cullingStats = frustumCulling.getStats();
+		} else {
+			uint32_t objectCount = static_cast<uint32_t>(objects.size());
+			cullingStats = {objectCount, objectCount};
+		}
+		const std::vector<uint8_t>& visibility = frustumCulling.getVisibility();
+		uint32_t visibleObjects = cullingStats.visibleObjects;
+
+		batches.clear();
+		renderQueue.clear();
+		if (visibleObjects == 0) {
+			return;
+		}
+
+		// Count the visible instances of every model, then give each model a contiguous
+		// range. Objects of one model usually come in runs, so the last batch is checked first.
+		uint32_t batch = 0;
+		for (uint32_t i = 0; i < objects.size(); i++) {
+			if (cpuCulling && !visibility[i]) {
+				continue;
+			}
+			if (batches.empty() || batches[batch].model != objects[i].model) {
+				batch = findBatch(objects[i].model);
+			}
+			batches[batch].instanceCount++;
+		}
+		uint32_t batchCount = static_cast<uint32_t>(batches.size());
+
+		// Every batch uses the same pipeline and descriptor sets, so only the mesh orders them
+		for (uint32_t i = 0; i < batchCount; i++) {
+			renderQueue.push(batches[i].model->getMeshId(), i);
+		}
+		renderQueue.sort();
+		reserveInstances(frameInfo.frameIndex, visibleObjects);
+		reserveBatches(frameInfo.frameIndex, batchCount);
+
+		// Every batch starts with no visible instances; the culling pass adds them
+		auto* batchData = static_cast<CullBatchData*>(resources.batches->getMappedMemory());
+		// Models without indices put a VkDrawIndirectCommand in their slot instead. Its
+		// instance count sits at the same offset, so the culling pass fills in either kind.
+		static_assert(offsetof(VkDrawIndirectCommand, instanceCount) == offsetof(VkDrawIndexedIndirectCommand, instanceCount));
+		static_assert(sizeof(VkDrawIndirectCommand) <= sizeof(VkDrawIndexedIndirectCommand));
+		auto* commands = static_cast<VkDrawIndexedIndirectCommand*>(resources.drawCommands->getMappedMemory());
+		uint32_t firstInstance = 0;
+		for (uint32_t i = 0; i < batchCount; i++) {
+			InstanceBatch& entry = batches[i];
+			entry.firstInstance = firstInstance;
+			firstInstance += entry.instanceCount;
+
+			batchData[i].boundingSphere = entry.model->getBoundingSphere();
+			batchData[i].firstInstance = entry.firstInstance;
+			if (entry.model->hasIndices()) {
+				commands[i] = {entry.model->getIndexCount(), 0, 0, 0, 0};
+			} else {
+				*reinterpret_cast<VkDrawIndirectCommand*>(&commands[i]) = {entry.model->getVertexCount(), 0, 0, 0};
+			}
+		}
+		resources.batches->flush();
+		resources.drawCommands->flush();
+
+		// With CPU culling the GPU pass only sees what survived it
+		auto* instances = static_cast<InstanceData*>(resources.instances->getMappedMemory());
+		uint32_t instanceCount = 0;
+		for (uint32_t i = 0; i < objects.size(); i++) {
+			if (cpuCulling && !visibility[i]) {
+				continue;
+			}
+			const RenderObject& object = objects[i];
+			if (batches[batch].model != object.model) {
+				batch = findBatch(object.model);
+			}
+			InstanceData& instance = instances[instanceCount++];
+			instance.modelMatrix = object.matrices.modelMatrix;
+			instance.normalMatrix = object.matrices.normalMatrix;
+			instance.color = glm::vec4{object.color, 1.0f};
+			instance.batch = batch;
+		}
+		resources.instances->flush();
+
+		CullPushConstantData push{};
+		std::copy(std::begin(frustum.planes), std::end(frustum.planes), std::begin(push.frustumPlanes));
+		push.objectCount = instanceCount;
+		push.testFrustum = gpuFrustumCulling ? 1 : 0;
+
+		cullPipeline->bind(frameInfo.commandBuffer);
 		vkCmdBindDescriptorSets(
 			frameInfo.commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			cullPipelineLayout,
+			0,
+			1,
+			&resources.descriptorSet,
+			0,
+			nullptr
+			);
+		vkCmdPushConstants(frameInfo.commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstantData), &push);
+		vkCmdDispatch(frameInfo.commandBuffer, (push.objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+		// The draws read the commands as indirect parameters and the visible
+		// instance indices from the vertex shader
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+			0,
+			1,
+			&barrier,
+			0,
+			nullptr,
+			0,
+			nullptr
+			);
+	}
+
+	void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
+		auto start = std::chrono::steady_clock::now();
+		renderStats = recordBatches(frameInfo, frameInfo.commandBuffer, 0, renderQueue.size());
+		recordingMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		recordingBufferCount = 0;
+	}
+
+	void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo, YellowstoneRenderer& renderer, YellowstoneThreadPool& threadPool) {
+		auto start = std::chrono::steady_clock::now();
+		uint32_t batchCount = renderQueue.size();
+		renderStats = RenderStats{};
+		recordingMilliseconds = 0.0f;
+		recordingBufferCount = 0;
+		if (batchCount == 0) {
+			return;
+		}
+
+		// One secondary buffer per thread that can record, unless there are too few models
+		// to make up for the cost of another buffer
+		uint32_t rangeCount = std::min(threadPool.getWorkerCount() + 1, (batchCount + MIN_BATCHES_PER_SECONDARY - 1) / MIN_BATCHES_PER_SECONDARY);
+		struct Recording {
+			FrameInfo& frameInfo;
+			YellowstoneRenderer& renderer;
+			uint32_t firstBuffer;
+			uint32_t rangeCount;
+			uint32_t batchCount;
+		};
+		Recording recording{frameInfo, renderer, renderer.reserveSecondaryCommandBuffers(rangeCount), rangeCount, batchCount};
+		recordingStats.resize(rangeCount);
+		// Captures stay small enough for std::function to keep them inline
+		threadPool.parallelFor(rangeCount, [this, &recording](uint32_t range) {
+			uint32_t begin = static_cast<uint32_t>(uint64_t{recording.batchCount} * range / recording.rangeCount);
+			uint32_t end = static_cast<uint32_t>(uint64_t{recording.batchCount} * (range + 1) / recording.rangeCount);
+			VkCommandBuffer commandBuffer = recording.renderer.beginSecondaryCommandBuffer(recording.firstBuffer + range);
+			recordingStats[range] = recordBatches(recording.frameInfo, commandBuffer, begin, end);
+			recording.renderer.endSecondaryCommandBuffer(commandBuffer);
+		});
+		for (uint32_t range = 0; range < rangeCount; range++) {
+			renderStats += recordingStats[range];
+		}
+		recordingMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		recordingBufferCount = rangeCount;
+	}
+
+	RenderStats SimpleRenderSystem::recordBatches(const FrameInfo& frameInfo, VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end) {
+		RenderStats stats{};
+		if (begin == end) {
+			return stats;
+		}
+
+		// Every batch shares the pipeline and both sets, so they're bound once per command buffer
+		FrameResources& resources = frames[frameInfo.frameIndex];
+		yellowstonePipeline->bind(commandBuffer);
+		VkDescriptorSet descriptorSets[] = {frameInfo.descriptorSet, resources.descriptorSet};
+		vkCmdBindDescriptorSets(
+			commandBuffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
 			pipelineLayout,
 			0,
-			1,
-			&frameInfo.descriptorSet,
+			2,
+			descriptorSets,
 			0,
 			nullptr
 			);
+		stats.pipelineBinds++;
+		stats.descriptorBinds++;
 
-		for (auto& kv : frameInfo.gameObjects) {
-			auto& obj = kv.second;
-			if (obj.model == nullptr) {
-				continue;
+		// A model whose instances were all culled draws nothing: its command has an instance
+		// count of 0
+		const VkDeviceSize commandStride = sizeof(VkDrawIndexedIndirectCommand);
+		for (uint32_t position = begin; position < end; position++) {
+			uint32_t i = renderQueue[position].draw;
+			const InstanceBatch& entry = batches[i];
+			entry.model->bind(commandBuffer);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t), &entry.firstInstance);
+			if (entry.model->hasIndices()) {
+				vkCmdDrawIndexedIndirect(commandBuffer, resources.drawCommands->getBuffer(), i * commandStride, 1, static_cast<uint32_t>(commandStride));
+			} else {
+				vkCmdDrawIndirect(commandBuffer, resources.drawCommands->getBuffer(), i * commandStride, 1, static_cast<uint32_t>(commandStride));
 			}
-			SimplePushConstantData push{};
-			push.modelMatrix = obj.transform.mat4();
-			push.normalMatrix = obj.transform.normalMatrix();
-			vkCmdPushConstants(
-				frameInfo.commandBuffer,
-				pipelineLayout,
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				0,
-				sizeof(SimplePushConstantData),
-				&push
-			);
-			obj.model->bind(frameInfo.commandBuffer);
-			obj.model->draw(frameInfo.commandBuffer);
+			stats.bufferBinds++;
+			stats.draws++;
 		}
+		return stats;
 	}
 }
\ No newline at end of file
@@ -2,30 +2,148 @@
 
 #include "../yellowstone_pipeline.hpp"
 #include "../yellowstone_device.hpp"
-#include "../yellowstone_game_object.hpp"
+#include "../ecs/components.hpp"
+#include "../yellowstone_model.hpp"
 #include "../yellowstone_camera.hpp"
 #include "../yellowstone_frame_info.hpp"
+#include "../yellowstone_buffer.hpp"
+#include "../yellowstone_descriptors.hpp"
+#include "../yellowstone_thread_pool.hpp"
+#include "../yellowstone_renderer.hpp"
+#include "../yellowstone_render_queue.hpp"
+#include "frustum_culling_system.hpp"
 
 #include <memory>
 #include <vector>
 
 namespace yellowstone {
 
+    // Per-instance data read by simple_shader.vert and cull.comp, laid out for std430
+    struct InstanceData {
+        glm::mat4 modelMatrix{ 1.0f };
+        glm::mat4 normalMatrix{ 1.0f };
+        glm::vec4 color{ 1.0f };
+        // Index of the instance's model in the frame's batch list
+        uint32_t batch = 0;
+        uint32_t padding[3]{};
+    };
+
+    // Per-model entry read by cull.comp
+    struct CullBatchData {
+        // Model space bounding sphere: center in xyz, radius in w
+        glm::vec4 boundingSphere{ 0.0f };
+        // Start of the model's range in the visible instance buffer
+        uint32_t firstInstance = 0;
+        uint32_t padding[3]{};
+    };
+
+    struct CullPushConstantData {
+        // World space planes with normals pointing inwards: left, right, bottom, top, near, far
+        glm::vec4 frustumPlanes[6];
+        uint32_t objectCount;
+        // Zero when the objects were already culled on the CPU, so the pass only compacts
+        uint32_t testFrustum;
+    };
+
+    // Culls objects against the view frustum and draws every model with one indirect draw.
+    // By default objects outside the frustum are dropped on the CPU before being uploaded;
+    // with GPU frustum culling every object is uploaded and the compute pass tests them
+    // instead. Either way the compute pass writes the indices of the instances it keeps into
+    // a contiguous range per model, along with the instance count of that model's draw
+    // command. Every model has its own vertex and index buffers, so each gets a single-draw
+    // vkCmdDrawIndexedIndirect, or vkCmdDrawIndirect for a model without indices. A GPU
+    // written draw count would only ever be 0 or 1 for those; a culled model's command
+    // already draws nothing with an instance count of 0.
     class SimpleRenderSystem {
     public:
+        static constexpr uint32_t INITIAL_INSTANCE_CAPACITY = 1024;
+        static constexpr uint32_t INITIAL_BATCH_CAPACITY = 64;
+        // Matches local_size_x in cull.comp
+        static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+        // Fewest models worth recording into a secondary command buffer of their own.
+        // Recording costs a few commands per model, not per object, because all of a model's
+        // instances go into one indirect draw. So parallel recording only starts to pay off
+        // with more than this many distinct models per thread. Scenes with a handful of models
+        // record into a single secondary buffer on one thread however many objects they have.
+        static constexpr uint32_t MIN_BATCHES_PER_SECONDARY = 64;
+
         SimpleRenderSystem(YellowstoneDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
         ~SimpleRenderSystem();
         SimpleRenderSystem(const SimpleRenderSystem&) = delete;
         SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
+        // Uploads the visible objects of the frame's snapshot and records the culling pass.
+        // Has to be recorded outside the render pass, before renderGameObjects().
+        void cullGameObjects(FrameInfo& frameInfo, YellowstoneThreadPool* threadPool = nullptr);
+        // Records the indirect draws filled in by the culling pass into the frame's command buffer
         void renderGameObjects(FrameInfo& frameInfo);
+        // Same, but split across the thread pool with each thread recording its share of the
+        // models into a secondary command buffer. The render pass must have been begun with
+        // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+        void renderGameObjects(FrameInfo& frameInfo, YellowstoneRenderer& renderer, YellowstoneThreadPool& threadPool);
+
+        // Binds and indirect draws recorded by the last renderGameObjects(), one draw per distinct model
+        const RenderStats& getRenderStats() const { return renderStats; }
+        // Wall time of the last renderGameObjects() and how many secondary command buffers it
+        // split the draws across (0 when recording inline)
+        float getRecordingMilliseconds() const { return recordingMilliseconds; }
+        uint32_t getRecordingBufferCount() const { return recordingBufferCount; }
+        // Moves the frustum test from the CPU into the culling pass, trading CPU time for
+        // uploading and testing every object on the GPU
+        void setGpuFrustumCulling(bool enabled) { gpuFrustumCulling = enabled; }
+        bool isGpuFrustumCulling() const { return gpuFrustumCulling; }
+
+        // Objects tested and kept by the last cullGameObjects(). The culling pass's result is
+        // never read back, so with GPU frustum culling every object counts as visible.
+        const FrustumCullingStats& getCullingStats() const { return cullingStats; }
 
     private:
-        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
-        void createPipeline(VkRenderPass renderPass);
+        struct InstanceBatch {
+            YellowstoneModel* model;
+            uint32_t firstInstance;
+            uint32_t instanceCount;
+        };
+
+        // Everything the culling pass reads and writes, one set per frame in flight so the
+        // CPU never writes a buffer the GPU is still using
+        struct FrameResources {
+            std::unique_ptr<YellowstoneBuffer> instances;
+            std::unique_ptr<YellowstoneBuffer> visibleInstances;
+            std::unique_ptr<YellowstoneBuffer> batches;
+            std::unique_ptr<YellowstoneBuffer> drawCommands;
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        };
+
+        void createCullDescriptors();
+        void createPipelineLayouts(VkDescriptorSetLayout globalSetLayout);
+        void createPipelines(VkRenderPass renderPass);
+        // Grow the frame's buffers to hold at least 'count' instances or batches
+        void reserveInstances(int frameIndex, uint32_t count);
+        void reserveBatches(int frameIndex, uint32_t count);
+        void writeDescriptorSet(int frameIndex);
+        uint32_t findBatch(YellowstoneModel* model);
+        // Records the draws of render queue entries [begin, end)
+        RenderStats recordBatches(const FrameInfo& frameInfo, VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end);
 
         YellowstoneDevice& yellowstoneDevice;
         std::unique_ptr<YellowstonePipeline> yellowstonePipeline;
         VkPipelineLayout pipelineLayout;
+        std::unique_ptr<YellowstoneComputePipeline> cullPipeline;
+        VkPipelineLayout cullPipelineLayout;
+
+        std::unique_ptr<YellowstoneDescriptorPool> cullPool;
+        std::unique_ptr<YellowstoneDescriptorSetLayout> cullSetLayout;
+        std::vector<FrameResources> frames;
+
+        FrustumCullingSystem frustumCulling;
+        bool gpuFrustumCulling = false;
+        FrustumCullingStats cullingStats{};
+        std::vector<InstanceBatch> batches;
+        YellowstoneRenderQueue renderQueue;
+        // One per secondary command buffer recorded in parallel, summed into renderStats
+        std::vector<RenderStats> recordingStats;
+        RenderStats renderStats{};
+        float recordingMilliseconds = 0.0f;
+        uint32_t recordingBufferCount = 0;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,127 @@
+#include "simulation_stage.hpp"
+#include "system_scheduler.hpp"
+#include "../yellowstone_allocation_tracker.hpp"
+#include "../yellowstone_frame_arena.hpp"
+
+#include <chrono>
+
+namespace yellowstone {
+
+	SimulationStage::SimulationStage(YellowstoneThreadPool& threadPool, uint32_t physicsWorkerCount, float physicsStepRate, uint32_t frameQueueDepth)
+		: threadPool{threadPool}, physicsThread{physicsSystem, physicsStepRate}, frameQueue{frameQueueDepth} {
+		physicsSystem.setWorkerThreadCount(physicsWorkerCount);
+	}
+
+	SimulationStage::~SimulationStage() {
+		stop();
+	}
+
+	void SimulationStage::loadDemoScene(std::shared_ptr<YellowstoneModel> cubeModel, std::shared_ptr<YellowstoneModel> quadModel) {
+		// Create ground plane (static)
+		TransformComponent groundTransform{};
+		groundTransform.translation = {0.0f, 0.1f, 0.0f};
+		groundTransform.scale = glm::vec3(10.0f, 1.0f, 10.0f);
+		auto ground = registry.create(
+			groundTransform,
+			PhysicsComponent{},
+			StaticComponent{},
+			MeshComponent{quadModel, glm::vec3(0.3f, 0.3f, 0.3f)});
+		initialStates[ground] = {groundTransform, PhysicsComponent{}};
+
+		// Create falling cubes with different initial positions and velocities
+		// In Y-down system: negative Y is above ground, positive Y is below ground
+		for (int i = 0; i < 5; i++) {
+			TransformComponent transform{};
+			transform.translation = {
+				-2.0f + i * 1.0f,
+				-5.0f - i * 0.5f,  // Negative Y = above ground
+				0.0f
+			};
+			transform.scale = glm::vec3(0.3f, 0.3f, 0.3f);
+			PhysicsComponent physics{glm::vec3(0.0f, 0.0f, 0.0f), 1.0f};
+			// Different colors for visual variety
+			glm::vec3 color{
+				0.5f + (i % 3) * 0.2f,
+				0.3f + ((i + 1) % 3) * 0.2f,
+				0.4f + ((i + 2) % 3) * 0.2f
+			};
+			auto cube = registry.create(transform, physics, MeshComponent{cubeModel, color});
+			initialStates[cube] = {transform, physics};
+		}
+
+		// Add a few cubes with initial horizontal velocity
+		for (int i = 0; i < 3; i++) {
+			TransformComponent transform{};
+			transform.translation = {
+				-1.5f + i * 1.5f,
+				-8.0f,  // Negative Y = above ground
+				1.0f
+			};
+			transform.scale = glm::vec3(0.4f, 0.4f, 0.4f);
+			PhysicsComponent physics{glm::vec3(0.5f - i * 0.5f, 0.0f, -0.3f), 1.5f};
+			auto cube = registry.create(transform, physics, MeshComponent{cubeModel, glm::vec3(0.8f, 0.2f, 0.2f)});
+			initialStates[cube] = {transform, physics};
+		}
+	}
+
+	void SimulationStage::start() {
+		physicsThread.start(registry);
+		simulationThread = std::thread([this]() { run(); });
+	}
+
+	void SimulationStage::stop() {
+		frameQueue.close();
+		if (simulationThread.joinable()) {
+			simulationThread.join();
+		}
+		physicsThread.stop();
+	}
+
+	void SimulationStage::run() {
+		RenderSnapshot* snapshot = nullptr;
+		SystemScheduler simulationScheduler;
+		simulationScheduler.addSystem("physics interpolation", SystemAccess{}.write<TransformComponent, PhysicsComponent>(), [&]() {
+			// Pick up the latest physics state, interpolated for this frame
+			physicsThread.interpolate(registry);
+		});
+		simulationScheduler.addSystem("transform hierarchy", SystemAccess{}.read<PhysicsComponent>().write<TransformComponent, HierarchyComponent>(), [&]() {
+			transformHierarchySystem.update(registry, &threadPool);
+		});
+		// Capturing updates the transforms' cached matrices, so it counts as a write
+		simulationScheduler.addSystem("render snapshot", SystemAccess{}.read<MeshComponent, HierarchyComponent>().write<TransformComponent, RenderSnapshotResource>(), [&]() {
+			captureRenderObjects(registry, *snapshot);
+		});
+
+		uint64_t frameNumber = 0;
+		while ((snapshot = frameQueue.beginWrite()) != nullptr) {
+			auto start = std::chrono::steady_clock::now();
+			AllocationScope allocationScope{"simulation"};
+			YellowstoneFrameArena::beginFrame(static_cast<uint32_t>(frameNumber));
+			if (resetRequested.exchange(false)) {
+				resetSimulation();
+			}
+			simulationScheduler.run(threadPool);
+
+			snapshot->frameNumber = frameNumber++;
+			snapshot->simulationStart = start;
+			snapshot->simulationMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			frameQueue.endWrite(snapshot);
+		}
+	}
+
+	void SimulationStage::resetSimulation() {
+		// Reset all physics entities to their initial state
+		registry.each<TransformComponent, PhysicsComponent>([&](Entity entity, TransformComponent& transform, PhysicsComponent& physics) {
+			// Only reset if we have initial state stored
+			auto it = initialStates.find(entity);
+			if (it != initialStates.end()) {
+				transform = it->second.transform;
+				physics = it->second.physics;
+			}
+		});
+
+		// The physics world keeps its own copy of body state
+		physicsThread.reset(registry);
+	}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../ecs/components.hpp"
+#include "../ecs/registry.hpp"
+#include "../yellowstone_frame_queue.hpp"
+#include "../yellowstone_thread_pool.hpp"
+#include "physics_system.hpp"
+#include "physics_thread.hpp"
+#include "render_snapshot.hpp"
+#include "transform_hierarchy_system.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace yellowstone {
+
+	// The simulation half of the frame pipeline. It holds no GPU state, so the app and the
+	// headless benchmarks run the same code. Physics steps at a fixed rate on its own thread.
+	// A second thread, once per frame, interpolates physics into the registry, propagates the
+	// transform hierarchy and captures a RenderSnapshot into the frame queue for the render
+	// stage to read.
+	//
+	// Physics solves islands on a job system of its own. A thread waiting on a pool runs
+	// whatever that pool has queued, so sharing one would let the physics step pick up render
+	// jobs and the render stage pick up island solves.
+	class SimulationStage {
+	public:
+		// 'threadPool' runs the per-frame work and may be shared with the render stage
+		SimulationStage(YellowstoneThreadPool& threadPool, uint32_t physicsWorkerCount, float physicsStepRate, uint32_t frameQueueDepth);
+		~SimulationStage();
+		SimulationStage(const SimulationStage&) = delete;
+		SimulationStage& operator=(const SimulationStage&) = delete;
+
+		// Fills the registry with the demo scene; models may be null when nothing is drawn.
+		// Call before start().
+		void loadDemoScene(std::shared_ptr<YellowstoneModel> cubeModel, std::shared_ptr<YellowstoneModel> quadModel);
+
+		void start();
+		// Closes the frame queue, so a render stage waiting on it wakes up, and joins both threads
+		void stop();
+		// Puts the scene's bodies back where they started at the beginning of the next frame.
+		// Safe to call from any thread.
+		void requestReset() { resetRequested = true; }
+
+		// The render stage reads snapshots from here while the stage runs
+		YellowstoneFrameQueue<RenderSnapshot>& getFrameQueue() { return frameQueue; }
+		const PhysicsThread& getPhysicsThread() const { return physicsThread; }
+
+	private:
+		struct InitialState {
+			TransformComponent transform;
+			PhysicsComponent physics;
+		};
+
+		void run();
+		void resetSimulation();
+
+		YellowstoneThreadPool& threadPool;
+		PhysicsSystem physicsSystem{};
+		PhysicsThread physicsThread;
+		// Owned by the simulation thread while it runs
+		YellowstoneRegistry registry;
+		std::unordered_map<Entity, InitialState> initialStates;
+		TransformHierarchySystem transformHierarchySystem{};
+
+		YellowstoneFrameQueue<RenderSnapshot> frameQueue;
+		std::thread simulationThread;
+		std::atomic<bool> resetRequested{false};
+	};
+
+}
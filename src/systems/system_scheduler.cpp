@@ -0,0 +1,103 @@
+#include "system_scheduler.hpp"
+#include "../yellowstone_frame_arena.hpp"
+
+#include <chrono>
+
+namespace yellowstone {
+
+	uint32_t SystemScheduler::addSystem(std::string name, const SystemAccess& access, std::function<void()> update) {
+		uint32_t index = static_cast<uint32_t>(systems.size());
+		auto system = std::make_unique<System>();
+		system->name = std::move(name);
+		system->access = access;
+		system->update = std::move(update);
+
+		// Skip dependencies that are already implied through another one, so the graph
+		// stays small when many systems touch the same components
+		std::vector<uint8_t> implied(index, 0);
+		for (uint32_t j = index; j-- > 0;) {
+			if (implied[j]) {
+				for (uint32_t dependency : systems[j]->dependencies) {
+					implied[dependency] = 1;
+				}
+				continue;
+			}
+			if (access.conflictsWith(systems[j]->access)) {
+				system->dependencies.push_back(j);
+				systems[j]->dependents.push_back(index);
+				for (uint32_t dependency : systems[j]->dependencies) {
+					implied[dependency] = 1;
+				}
+			}
+		}
+
+		systems.push_back(std::move(system));
+		return index;
+	}
+
+	void SystemScheduler::run(YellowstoneThreadPool& threadPool) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for (auto& system : systems) {
+			system->remainingDependencies.store(static_cast<uint32_t>(system->dependencies.size()), std::memory_order_relaxed);
+		}
+
+		JobCounter counter;
+		for (uint32_t i = 0; i < systems.size(); i++) {
+			if (systems[i]->dependencies.empty()) {
+				launch(i, threadPool, counter);
+			}
+		}
+		threadPool.wait(counter);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		stats.frameMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		computeCriticalPath();
+	}
+
+	void SystemScheduler::launch(uint32_t index, YellowstoneThreadPool& threadPool, JobCounter& counter) {
+		threadPool.submit([this, index, &threadPool, &counter]() {
+			System& system = *systems[index];
+			auto start = std::chrono::high_resolution_clock::now();
+			system.update();
+			auto end = std::chrono::high_resolution_clock::now();
+			system.milliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+			for (uint32_t dependent : system.dependents) {
+				if (systems[dependent]->remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					launch(dependent, threadPool, counter);
+				}
+			}
+		}, &counter);
+	}
+
+	void SystemScheduler::computeCriticalPath() {
+		// Dependencies always point to earlier systems, so index order is a topological order
+		FrameArenaScope arenaScope;
+		FrameVector<float> finish(systems.size(), 0.0f);
+		FrameVector<int32_t> previous(systems.size(), -1);
+		stats.workMilliseconds = 0.0f;
+		int32_t last = -1;
+		for (uint32_t i = 0; i < systems.size(); i++) {
+			float ready = 0.0f;
+			for (uint32_t dependency : systems[i]->dependencies) {
+				if (finish[dependency] > ready) {
+					ready = finish[dependency];
+					previous[i] = static_cast<int32_t>(dependency);
+				}
+			}
+			finish[i] = ready + systems[i]->milliseconds;
+			stats.workMilliseconds += systems[i]->milliseconds;
+			if (last < 0 || finish[i] > finish[last]) {
+				last = static_cast<int32_t>(i);
+			}
+		}
+
+		criticalPath.clear();
+		for (int32_t i = last; i >= 0; i = previous[i]) {
+			criticalPath.insert(criticalPath.begin(), static_cast<uint32_t>(i));
+		}
+		stats.criticalPathMilliseconds = last >= 0 ? finish[last] : 0.0f;
+		stats.criticalPathLength = static_cast<uint32_t>(criticalPath.size());
+	}
+
+}
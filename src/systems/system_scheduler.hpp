@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../ecs/archetype.hpp"
+#include "../yellowstone_thread_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace yellowstone {
+
+	// What a system touches, as component types. State that lives outside the registry, like
+	// the camera or the frame's command buffer, can be declared through an empty tag type.
+	struct SystemAccess {
+		ComponentMask reads = 0;
+		ComponentMask writes = 0;
+
+		template <typename... Ts>
+		SystemAccess& read() {
+			reads |= ((ComponentMask{1} << componentTypeId<Ts>()) | ...);
+			return *this;
+		}
+
+		template <typename... Ts>
+		SystemAccess& write() {
+			writes |= ((ComponentMask{1} << componentTypeId<Ts>()) | ...);
+			return *this;
+		}
+
+		// Two systems conflict unless both only read whatever they share
+		bool conflictsWith(const SystemAccess& other) const {
+			return (writes & (other.reads | other.writes)) != 0 || (reads & other.writes) != 0;
+		}
+	};
+
+	struct SchedulerStats {
+		// Wall time of the last run()
+		float frameMilliseconds;
+		// Time of all systems added up
+		float workMilliseconds;
+		// Longest chain of dependent systems, the lower bound for frameMilliseconds however
+		// many threads there are
+		float criticalPathMilliseconds;
+		uint32_t criticalPathLength;
+	};
+
+	// Runs a fixed set of systems once per frame on the job system. Each system that conflicts
+	// with one added before it waits for that one to finish; everything else runs
+	// concurrently, so the order of addSystem() calls is the order hazards resolve in.
+	class SystemScheduler {
+	public:
+		SystemScheduler() = default;
+		SystemScheduler(const SystemScheduler&) = delete;
+		SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+		uint32_t addSystem(std::string name, const SystemAccess& access, std::function<void()> update);
+		// Runs every system once and returns when all are done. The calling thread helps out.
+		void run(YellowstoneThreadPool& threadPool);
+
+		const SchedulerStats& getStats() const { return stats; }
+		// Systems on the critical path of the last run, in order
+		const std::vector<uint32_t>& getCriticalPath() const { return criticalPath; }
+		uint32_t getSystemCount() const { return static_cast<uint32_t>(systems.size()); }
+		const std::string& getSystemName(uint32_t index) const { return systems[index]->name; }
+		float getSystemMilliseconds(uint32_t index) const { return systems[index]->milliseconds; }
+		// Earlier systems this one waits for
+		const std::vector<uint32_t>& getDependencies(uint32_t index) const { return systems[index]->dependencies; }
+
+	private:
+		struct System {
+			std::string name;
+			SystemAccess access;
+			std::function<void()> update;
+			std::vector<uint32_t> dependencies;
+			std::vector<uint32_t> dependents;
+			std::atomic<uint32_t> remainingDependencies{0};
+			float milliseconds = 0.0f;
+		};
+
+		void launch(uint32_t index, YellowstoneThreadPool& threadPool, JobCounter& counter);
+		void computeCriticalPath();
+
+		std::vector<std::unique_ptr<System>> systems;
+		std::vector<uint32_t> criticalPath;
+		SchedulerStats stats{};
+	};
+
+}
@@ -0,0 +1,154 @@
+#include "transform_hierarchy_system.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace yellowstone {
+
+	void TransformHierarchySystem::markStructureDirty() {
+		structureDirty = true;
+	}
+
+	void TransformHierarchySystem::update(YellowstoneRegistry& registry, YellowstoneThreadPool* threadPool) {
+		if (structureDirty || &registry != builtRegistry || registry.getVersion() != builtVersion) {
+			rebuild(registry);
+		}
+
+		uint32_t updatedNodes = 0;
+		for (size_t level = 0; level + 1 < levelOffsets.size(); level++) {
+			uint32_t begin = levelOffsets[level];
+			uint32_t end = levelOffsets[level + 1];
+			if (threadPool == nullptr || end - begin <= parallelChunkSize) {
+				updatedNodes += propagate(begin, end);
+				continue;
+			}
+
+			std::atomic<uint32_t> levelUpdated{0};
+			threadPool->parallelFor(begin, end, parallelChunkSize, [&](uint32_t chunkBegin, uint32_t chunkEnd) {
+				levelUpdated.fetch_add(propagate(chunkBegin, chunkEnd), std::memory_order_relaxed);
+			});
+			updatedNodes += levelUpdated.load(std::memory_order_relaxed);
+		}
+
+		forceUpdate = false;
+		stats.updatedNodes = updatedNodes;
+	}
+
+	uint32_t TransformHierarchySystem::propagate(uint32_t begin, uint32_t end) {
+		uint32_t updated = 0;
+		for (uint32_t i = begin; i < end; i++) {
+			TransformComponent& transform = *transforms[i];
+			int32_t parent = parents[i];
+			// updateMatrices() has to run for every node so the local cache stays current
+			bool localChanged = transform.updateMatrices();
+			bool dirty = localChanged || forceUpdate || (parent >= 0 && changed[parent]);
+			changed[i] = dirty;
+			if (!dirty) {
+				continue;
+			}
+
+			HierarchyComponent& hierarchy = *hierarchies[i];
+			if (parent >= 0) {
+				const HierarchyComponent& parentHierarchy = *hierarchies[parent];
+				hierarchy.worldMatrix = parentHierarchy.worldMatrix * transform.mat4();
+				// The inverse transpose of a product is the product of the inverse transposes
+				hierarchy.worldNormalMatrix = parentHierarchy.worldNormalMatrix * transform.normalMatrix();
+			} else {
+				hierarchy.worldMatrix = transform.mat4();
+				hierarchy.worldNormalMatrix = transform.normalMatrix();
+			}
+			updated++;
+		}
+		return updated;
+	}
+
+	void TransformHierarchySystem::rebuild(YellowstoneRegistry& registry) {
+		std::vector<Entity> entities;
+		std::vector<TransformComponent*> nodeTransforms;
+		std::vector<HierarchyComponent*> nodeHierarchies;
+		std::unordered_map<Entity, uint32_t> lookup;
+		registry.each<TransformComponent, HierarchyComponent>([&](Entity entity, TransformComponent& transform, HierarchyComponent& hierarchy) {
+			lookup[entity] = static_cast<uint32_t>(entities.size());
+			entities.push_back(entity);
+			nodeTransforms.push_back(&transform);
+			nodeHierarchies.push_back(&hierarchy);
+		});
+		uint32_t nodeCount = static_cast<uint32_t>(entities.size());
+
+		// Children of each node as ranges of one array; a parent outside the hierarchy makes
+		// the node a root
+		std::vector<int32_t> parentNode(nodeCount, -1);
+		std::vector<uint32_t> childOffsets(nodeCount + 1, 0);
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			auto it = lookup.find(nodeHierarchies[i]->parent);
+			if (it != lookup.end()) {
+				// PhysicsSystem writes world positions into TransformComponent::translation,
+				// which is only the world position for roots
+				if (registry.get<PhysicsComponent>(entities[i]) != nullptr) {
+					throw std::runtime_error("transform hierarchy node with a parent has a PhysicsComponent");
+				}
+				parentNode[i] = static_cast<int32_t>(it->second);
+				childOffsets[it->second + 1]++;
+			}
+		}
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			childOffsets[i + 1] += childOffsets[i];
+		}
+		std::vector<uint32_t> children(childOffsets[nodeCount]);
+		std::vector<uint32_t> childFill(childOffsets.begin(), childOffsets.end() - 1);
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			if (parentNode[i] >= 0) {
+				children[childFill[parentNode[i]]++] = i;
+			}
+		}
+
+		// Breadth-first from the roots; positions of each level are contiguous and siblings
+		// are adjacent
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> depth(nodeCount, 0);
+		std::vector<int32_t> position(nodeCount, -1);
+		order.reserve(nodeCount);
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			if (parentNode[i] < 0) {
+				order.push_back(i);
+			}
+		}
+		levelOffsets.clear();
+		for (size_t head = 0; head < order.size(); head++) {
+			uint32_t node = order[head];
+			position[node] = static_cast<int32_t>(head);
+			if (head == 0 || depth[node] != depth[order[head - 1]]) {
+				levelOffsets.push_back(static_cast<uint32_t>(head));
+			}
+			for (uint32_t c = childOffsets[node]; c < childOffsets[node + 1]; c++) {
+				depth[children[c]] = depth[node] + 1;
+				order.push_back(children[c]);
+			}
+		}
+		if (order.size() != nodeCount) {
+			throw std::runtime_error("transform hierarchy contains a cycle");
+		}
+		levelOffsets.push_back(nodeCount);
+
+		parents.resize(nodeCount);
+		transforms.resize(nodeCount);
+		hierarchies.resize(nodeCount);
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			uint32_t node = order[i];
+			parents[i] = parentNode[node] >= 0 ? position[parentNode[node]] : -1;
+			transforms[i] = nodeTransforms[node];
+			hierarchies[i] = nodeHierarchies[node];
+		}
+		changed.assign(nodeCount, 0);
+
+		builtRegistry = &registry;
+		builtVersion = registry.getVersion();
+		structureDirty = false;
+		// Nodes may have moved between parents, so everything is recomputed once
+		forceUpdate = true;
+		stats.nodeCount = nodeCount;
+		stats.levelCount = static_cast<uint32_t>(levelOffsets.size()) - 1;
+	}
+
+}
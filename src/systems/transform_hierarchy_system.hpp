@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../ecs/components.hpp"
+#include "../ecs/registry.hpp"
+#include "../yellowstone_thread_pool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	struct HierarchyStats {
+		uint32_t nodeCount;
+		// Depth of the deepest node plus one
+		uint32_t levelCount;
+		// Nodes whose world matrices were recomputed in the last update
+		uint32_t updatedNodes;
+	};
+
+	// Propagates local transforms to world matrices for every entity with a HierarchyComponent.
+	// Nodes are kept in breadth-first order in flat arrays with a parent index per node, so
+	// propagation is one forward pass in which every parent comes before its children. World
+	// matrices live only in the HierarchyComponents, where children read their parent's. Only
+	// nodes whose own transform changed, and their subtrees, are recomputed. Each level only
+	// depends on the one above, so wide levels are split across the thread pool.
+	class TransformHierarchySystem {
+	public:
+		TransformHierarchySystem() = default;
+		TransformHierarchySystem(const TransformHierarchySystem&) = delete;
+		TransformHierarchySystem& operator=(const TransformHierarchySystem&) = delete;
+
+		// Call once per frame before anything reads the world matrices. Entities in a
+		// hierarchy must have their matrices updated here only, not by calling
+		// TransformComponent::updateMatrices() elsewhere.
+		void update(YellowstoneRegistry& registry, YellowstoneThreadPool* threadPool = nullptr);
+		// Call after changing a HierarchyComponent's parent; adding or removing entities and
+		// components is picked up on its own. Throws if a node with a parent has a
+		// PhysicsComponent, since physics positions are world space.
+		void markStructureDirty();
+
+		const HierarchyStats& getStats() const { return stats; }
+
+	private:
+		void rebuild(YellowstoneRegistry& registry);
+		uint32_t propagate(uint32_t begin, uint32_t end);
+
+		// Levels wider than this are split into pieces of at most this size and run in parallel
+		const uint32_t parallelChunkSize = 2048;
+
+		YellowstoneRegistry* builtRegistry = nullptr;
+		uint64_t builtVersion = 0;
+		bool structureDirty = true;
+		bool forceUpdate = false;
+
+		// All indexed by position in breadth-first order. Component pointers stay valid until
+		// the registry's version changes, which triggers a rebuild.
+		std::vector<int32_t> parents;
+		std::vector<TransformComponent*> transforms;
+		std::vector<HierarchyComponent*> hierarchies;
+		std::vector<uint8_t> changed;
+		// First node of each level, plus one past the last node
+		std::vector<uint32_t> levelOffsets;
+
+		HierarchyStats stats{};
+	};
+
+}
@@ -0,0 +1,336 @@
+#include "yellowstone_allocation_tracker.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(YELLOWSTONE_TRACK_ALLOCATIONS) && defined(__GLIBC__)
+#include <execinfo.h>
+
+// glibc's own entry points, which the malloc hooks forward to
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* pointer);
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define YELLOWSTONE_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define YELLOWSTONE_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace yellowstone {
+
+#ifdef YELLOWSTONE_TRACK_ALLOCATIONS
+
+	namespace {
+
+		// Everything here is reached from inside malloc, so it must never allocate: only
+		// fixed tables of atomics, all constant-initialized so they work before main()
+		std::atomic<uint64_t> allocationCount{0};
+		std::atomic<uint64_t> freeCount{0};
+		std::atomic<uint64_t> allocatedBytes{0};
+
+		struct ScopeCounters {
+			std::atomic<const char*> name{nullptr};
+			std::atomic<uint64_t> allocations{0};
+			std::atomic<uint64_t> bytes{0};
+		};
+		// Slot 0 counts allocations made outside of any scope
+		ScopeCounters scopeCounters[AllocationStats::maxScopes];
+		std::atomic<uint32_t> scopeCount{1};
+
+		std::atomic<const void*> callSites[AllocationStats::maxCallSites];
+
+		thread_local const char* currentScope = nullptr;
+
+		ScopeCounters& findScope(const char* name) {
+			if (name == nullptr) {
+				return scopeCounters[0];
+			}
+			while (true) {
+				uint32_t count = scopeCount.load(std::memory_order_acquire);
+				for (uint32_t i = 1; i < count; i++) {
+					const char* slotName = scopeCounters[i].name.load(std::memory_order_acquire);
+					if (slotName == name || (slotName != nullptr && std::strcmp(slotName, name) == 0)) {
+						return scopeCounters[i];
+					}
+				}
+				if (count == AllocationStats::maxScopes) {
+					return scopeCounters[0];
+				}
+				// Claim the next slot; if another thread got there first, look again
+				const char* expected = nullptr;
+				if (scopeCounters[count].name.compare_exchange_strong(expected, name, std::memory_order_acq_rel)) {
+					scopeCount.store(count + 1, std::memory_order_release);
+					return scopeCounters[count];
+				}
+				while (scopeCount.load(std::memory_order_acquire) == count) {
+				}
+			}
+		}
+
+		void recordCallSite(const void* site) {
+			for (auto& slot : callSites) {
+				const void* current = slot.load(std::memory_order_relaxed);
+				if (current == site) {
+					return;
+				}
+				if (current == nullptr) {
+					if (slot.compare_exchange_strong(current, site, std::memory_order_relaxed) || current == site) {
+						return;
+					}
+				}
+			}
+		}
+
+		void recordAllocation(size_t size, const void* site) {
+			allocationCount.fetch_add(1, std::memory_order_relaxed);
+			allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+			ScopeCounters& scope = findScope(currentScope);
+			scope.allocations.fetch_add(1, std::memory_order_relaxed);
+			scope.bytes.fetch_add(size, std::memory_order_relaxed);
+			recordCallSite(site);
+		}
+
+		void recordFree() {
+			freeCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+	}
+
+#if defined(__GLIBC__)
+	namespace {
+
+		void* rawAllocate(size_t size) { return __libc_malloc(size); }
+		void* rawAllocateAligned(size_t size, size_t alignment) { return __libc_memalign(alignment, size); }
+		void rawFree(void* pointer) { __libc_free(pointer); }
+		void rawFreeAligned(void* pointer) { __libc_free(pointer); }
+
+	}
+#elif defined(_MSC_VER)
+	namespace {
+
+		void* rawAllocate(size_t size) { return std::malloc(size); }
+		void* rawAllocateAligned(size_t size, size_t alignment) { return _aligned_malloc(size, alignment); }
+		void rawFree(void* pointer) { std::free(pointer); }
+		void rawFreeAligned(void* pointer) { _aligned_free(pointer); }
+
+	}
+#else
+	namespace {
+
+		void* rawAllocate(size_t size) { return std::malloc(size); }
+		void* rawAllocateAligned(size_t size, size_t alignment) { return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment); }
+		void rawFree(void* pointer) { std::free(pointer); }
+		void rawFreeAligned(void* pointer) { std::free(pointer); }
+
+	}
+#endif
+
+	namespace {
+
+		void* trackedAllocate(size_t size, const void* site) {
+			recordAllocation(size, site);
+			void* pointer = rawAllocate(size == 0 ? 1 : size);
+			if (pointer == nullptr) {
+				throw std::bad_alloc();
+			}
+			return pointer;
+		}
+
+		void* trackedAllocateAligned(size_t size, size_t alignment, const void* site) {
+			recordAllocation(size, site);
+			void* pointer = rawAllocateAligned(size == 0 ? 1 : size, alignment);
+			if (pointer == nullptr) {
+				throw std::bad_alloc();
+			}
+			return pointer;
+		}
+
+		void trackedFree(void* pointer) {
+			if (pointer != nullptr) {
+				recordFree();
+				rawFree(pointer);
+			}
+		}
+
+		void trackedFreeAligned(void* pointer) {
+			if (pointer != nullptr) {
+				recordFree();
+				rawFreeAligned(pointer);
+			}
+		}
+
+	}
+
+	AllocationScope::AllocationScope(const char* name) : previous{currentScope} {
+		currentScope = name;
+	}
+
+	AllocationScope::~AllocationScope() {
+		currentScope = previous;
+	}
+
+	const char* AllocationScope::current() {
+		return currentScope;
+	}
+
+	AllocationStats YellowstoneAllocationTracker::collectFrame() {
+		AllocationStats stats{};
+		stats.allocations = allocationCount.exchange(0, std::memory_order_relaxed);
+		stats.frees = freeCount.exchange(0, std::memory_order_relaxed);
+		stats.bytes = allocatedBytes.exchange(0, std::memory_order_relaxed);
+
+		uint32_t count = scopeCount.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++) {
+			uint64_t allocations = scopeCounters[i].allocations.exchange(0, std::memory_order_relaxed);
+			uint64_t bytes = scopeCounters[i].bytes.exchange(0, std::memory_order_relaxed);
+			if (allocations > 0) {
+				stats.scopes[stats.scopeCount++] = {scopeCounters[i].name.load(std::memory_order_relaxed), allocations, bytes};
+			}
+		}
+		for (auto& slot : callSites) {
+			if (const void* site = slot.exchange(nullptr, std::memory_order_relaxed)) {
+				stats.callSites[stats.callSiteCount++] = site;
+			}
+		}
+		return stats;
+	}
+
+#else
+
+	AllocationStats YellowstoneAllocationTracker::collectFrame() {
+		return {};
+	}
+
+#endif
+
+	void YellowstoneAllocationTracker::print(const AllocationStats& stats, std::FILE* file) {
+		std::fprintf(file, "%llu allocations (%llu bytes), %llu frees\n",
+			static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.bytes),
+			static_cast<unsigned long long>(stats.frees));
+		for (uint32_t i = 0; i < stats.scopeCount; i++) {
+			const AllocationStats::ScopeStats& scope = stats.scopes[i];
+			std::fprintf(file, "  %-24s %8llu allocations %10llu bytes\n", scope.name != nullptr ? scope.name : "(no scope)",
+				static_cast<unsigned long long>(scope.allocations), static_cast<unsigned long long>(scope.bytes));
+		}
+		if (stats.callSiteCount == 0) {
+			return;
+		}
+#if defined(YELLOWSTONE_TRACK_ALLOCATIONS) && defined(__GLIBC__)
+		// Prints module(symbol+offset)[address] without allocating
+		std::fflush(file);
+		backtrace_symbols_fd(const_cast<void* const*>(stats.callSites.data()), static_cast<int>(stats.callSiteCount), fileno(file));
+#else
+		for (uint32_t i = 0; i < stats.callSiteCount; i++) {
+			std::fprintf(file, "  called from %p\n", stats.callSites[i]);
+		}
+#endif
+	}
+
+}
+
+#ifdef YELLOWSTONE_TRACK_ALLOCATIONS
+
+void* operator new(size_t size) {
+	return yellowstone::trackedAllocate(size, YELLOWSTONE_RETURN_ADDRESS());
+}
+
+void* operator new[](size_t size) {
+	return yellowstone::trackedAllocate(size, YELLOWSTONE_RETURN_ADDRESS());
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return yellowstone::trackedAllocate(size, YELLOWSTONE_RETURN_ADDRESS());
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return yellowstone::trackedAllocate(size, YELLOWSTONE_RETURN_ADDRESS());
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	return yellowstone::trackedAllocateAligned(size, static_cast<size_t>(alignment), YELLOWSTONE_RETURN_ADDRESS());
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return yellowstone::trackedAllocateAligned(size, static_cast<size_t>(alignment), YELLOWSTONE_RETURN_ADDRESS());
+}
+
+void operator delete(void* pointer) noexcept { yellowstone::trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { yellowstone::trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { yellowstone::trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { yellowstone::trackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { yellowstone::trackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { yellowstone::trackedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { yellowstone::trackedFreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { yellowstone::trackedFreeAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { yellowstone::trackedFreeAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { yellowstone::trackedFreeAligned(pointer); }
+
+#if defined(__GLIBC__)
+
+// Everything in the process that calls malloc or one of the aligned variants, drivers
+// included, ends up here
+extern "C" void* malloc(size_t size) {
+	yellowstone::recordAllocation(size, YELLOWSTONE_RETURN_ADDRESS());
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+	yellowstone::recordAllocation(count * size, YELLOWSTONE_RETURN_ADDRESS());
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+	yellowstone::recordAllocation(size, YELLOWSTONE_RETURN_ADDRESS());
+	return __libc_realloc(pointer, size);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) {
+	yellowstone::recordAllocation(size, YELLOWSTONE_RETURN_ADDRESS());
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+	yellowstone::recordAllocation(size, YELLOWSTONE_RETURN_ADDRESS());
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) {
+	// Rejected without allocating, as glibc does
+	if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0) {
+		return EINVAL;
+	}
+	yellowstone::recordAllocation(size, YELLOWSTONE_RETURN_ADDRESS());
+	void* pointer = __libc_memalign(alignment, size);
+	if (pointer == nullptr) {
+		return ENOMEM;
+	}
+	*result = pointer;
+	return 0;
+}
+
+extern "C" void free(void* pointer) {
+	if (pointer != nullptr) {
+		yellowstone::recordFree();
+	}
+	__libc_free(pointer);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+
+namespace yellowstone {
+
+	// Heap allocations made by every thread between two calls to
+	// YellowstoneAllocationTracker::collectFrame()
+	struct AllocationStats {
+		static constexpr uint32_t maxScopes = 16;
+		static constexpr uint32_t maxCallSites = 16;
+
+		struct ScopeStats {
+			// Null for allocations made outside of any AllocationScope
+			const char* name;
+			uint64_t allocations;
+			uint64_t bytes;
+		};
+
+		uint64_t allocations = 0;
+		uint64_t frees = 0;
+		uint64_t bytes = 0;
+		std::array<ScopeStats, maxScopes> scopes{};
+		uint32_t scopeCount = 0;
+		// Return addresses of the first distinct places that allocated
+		std::array<const void*, maxCallSites> callSites{};
+		uint32_t callSiteCount = 0;
+	};
+
+	// Counts calls to the global operator new/delete, and to malloc/free on glibc, when built
+	// with YELLOWSTONE_TRACK_ALLOCATIONS (the VKENGINE_TRACK_ALLOCATIONS CMake option).
+	// Otherwise nothing is hooked and collectFrame() always returns empty stats.
+	class YellowstoneAllocationTracker {
+	public:
+#ifdef YELLOWSTONE_TRACK_ALLOCATIONS
+		static constexpr bool enabled = true;
+#else
+		static constexpr bool enabled = false;
+#endif
+
+		// Returns what was allocated since the previous call and starts counting again
+		static AllocationStats collectFrame();
+		// One summary line, then a line per scope and per call site
+		static void print(const AllocationStats& stats, std::FILE* file);
+	};
+
+	// Tags allocations the calling thread makes while it is alive with 'name', which must
+	// outlive the program, e.g. a string literal. Scopes nest; the innermost one wins. Jobs
+	// run under the scope that was current where they were submitted.
+	class AllocationScope {
+	public:
+#ifdef YELLOWSTONE_TRACK_ALLOCATIONS
+		explicit AllocationScope(const char* name);
+		~AllocationScope();
+		// The calling thread's innermost scope name, or null outside of any scope
+		static const char* current();
+#else
+		explicit AllocationScope(const char*) {}
+		static const char* current() { return nullptr; }
+#endif
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+#ifdef YELLOWSTONE_TRACK_ALLOCATIONS
+	private:
+		const char* previous;
+#endif
+	};
+
+}
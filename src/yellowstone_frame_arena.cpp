@@ -0,0 +1,103 @@
+#include "yellowstone_frame_arena.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace yellowstone {
+
+	namespace {
+
+		struct ThreadArenas {
+			std::array<YellowstoneFrameArena, YellowstoneFrameArena::maxFramesInFlight> arenas;
+			uint32_t currentFrame = 0;
+		};
+
+		ThreadArenas& threadArenas() {
+			thread_local ThreadArenas arenas;
+			return arenas;
+		}
+
+	}
+
+	YellowstoneFrameArena::YellowstoneFrameArena(size_t capacity) : initialCapacity{capacity} {}
+
+	void* YellowstoneFrameArena::allocate(size_t size, size_t alignment) {
+		assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+		while (true) {
+			if (currentBlock < blocks.size()) {
+				Block& block = blocks[currentBlock];
+				uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+				size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+				if (aligned + size <= block.size) {
+					offset = aligned + size;
+					return block.memory.get() + aligned;
+				}
+				// Blocks kept around after a rewind are reused before allocating new ones
+				if (currentBlock + 1 < blocks.size() && size + alignment <= blocks[currentBlock + 1].size) {
+					currentBlock++;
+					offset = 0;
+					continue;
+				}
+			}
+			addBlock(size + alignment);
+		}
+	}
+
+	void YellowstoneFrameArena::addBlock(size_t minimumSize) {
+		size_t size = std::max({minimumSize, initialCapacity, getCapacity()});
+		Block block{std::unique_ptr<unsigned char[]>{new unsigned char[size]}, size};
+		heapAllocations++;
+		// Blocks past the current one were too small for this request; they are merged away at reset
+		blocks.insert(blocks.begin() + static_cast<ptrdiff_t>(std::min(currentBlock + 1, blocks.size())), std::move(block));
+		if (blocks.size() > 1) {
+			currentBlock++;
+		}
+		offset = 0;
+	}
+
+	void YellowstoneFrameArena::reset() {
+		if (blocks.size() > 1) {
+			// Replace the blocks by one that holds everything this frame needed
+			size_t total = getCapacity();
+			blocks.clear();
+			blocks.push_back({std::unique_ptr<unsigned char[]>{new unsigned char[total]}, total});
+		}
+		currentBlock = 0;
+		offset = 0;
+		heapAllocations = 0;
+	}
+
+	void YellowstoneFrameArena::rewind(Marker marker) {
+		currentBlock = marker.block;
+		offset = marker.offset;
+	}
+
+	size_t YellowstoneFrameArena::getCapacity() const {
+		size_t total = 0;
+		for (const Block& block : blocks) {
+			total += block.size;
+		}
+		return total;
+	}
+
+	size_t YellowstoneFrameArena::getUsedBytes() const {
+		size_t used = offset;
+		for (size_t i = 0; i < currentBlock && i < blocks.size(); i++) {
+			used += blocks[i].size;
+		}
+		return used;
+	}
+
+	YellowstoneFrameArena& YellowstoneFrameArena::current() {
+		ThreadArenas& arenas = threadArenas();
+		return arenas.arenas[arenas.currentFrame];
+	}
+
+	void YellowstoneFrameArena::beginFrame(uint32_t frameIndex) {
+		ThreadArenas& arenas = threadArenas();
+		arenas.currentFrame = frameIndex % maxFramesInFlight;
+		arenas.arenas[arenas.currentFrame].reset();
+	}
+
+}
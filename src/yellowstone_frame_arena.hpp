@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace yellowstone {
+
+	// Bump allocator for data that only lives for a frame. Allocating moves a pointer forward
+	// and freeing does nothing; everything is released at once by reset(), or back to a
+	// marker by rewind(). When a frame needs more than the buffer holds, extra blocks come
+	// from the heap, and the next reset() grows the buffer so steady-state frames don't.
+	class YellowstoneFrameArena {
+	public:
+		// Matches YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT
+		static constexpr uint32_t maxFramesInFlight = 2;
+		static constexpr size_t defaultCapacity = 256 * 1024;
+
+		explicit YellowstoneFrameArena(size_t capacity = defaultCapacity);
+		YellowstoneFrameArena(const YellowstoneFrameArena&) = delete;
+		YellowstoneFrameArena& operator=(const YellowstoneFrameArena&) = delete;
+
+		void* allocate(size_t size, size_t alignment);
+		void reset();
+
+		struct Marker {
+			size_t block;
+			size_t offset;
+		};
+		Marker mark() const { return {currentBlock, offset}; }
+		// Frees everything allocated after 'marker' was taken
+		void rewind(Marker marker);
+
+		size_t getCapacity() const;
+		size_t getUsedBytes() const;
+		// Blocks taken from the heap since the last reset; zero once the arena has warmed up
+		uint32_t getHeapAllocationCount() const { return heapAllocations; }
+
+		// The calling thread's arena for its current frame. Every thread has its own, one per
+		// frame in flight, so nothing here needs locking.
+		static YellowstoneFrameArena& current();
+		// Resets the calling thread's arena for 'frameIndex' and makes it current. Call at
+		// the start of a frame, once nothing from that frame's last use is still needed.
+		static void beginFrame(uint32_t frameIndex);
+
+	private:
+		struct Block {
+			std::unique_ptr<unsigned char[]> memory;
+			size_t size;
+		};
+
+		void addBlock(size_t minimumSize);
+
+		std::vector<Block> blocks;
+		size_t currentBlock = 0;
+		size_t offset = 0;
+		size_t initialCapacity;
+		uint32_t heapAllocations = 0;
+	};
+
+	// Frees everything allocated from the calling thread's current arena during its lifetime.
+	// Use it around temporary containers in code that may run outside of a frame.
+	class FrameArenaScope {
+	public:
+		FrameArenaScope() : arena{YellowstoneFrameArena::current()}, marker{arena.mark()} {}
+		~FrameArenaScope() { arena.rewind(marker); }
+		FrameArenaScope(const FrameArenaScope&) = delete;
+		FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+
+	private:
+		YellowstoneFrameArena& arena;
+		YellowstoneFrameArena::Marker marker;
+	};
+
+	// STL allocator drawing from an arena, the calling thread's current one by default
+	template <typename T>
+	class FrameAllocator {
+	public:
+		using value_type = T;
+
+		FrameAllocator() : arena{&YellowstoneFrameArena::current()} {}
+		explicit FrameAllocator(YellowstoneFrameArena& arena) : arena{&arena} {}
+		template <typename U>
+		FrameAllocator(const FrameAllocator<U>& other) : arena{other.getArena()} {}
+
+		T* allocate(size_t count) {
+			return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+		}
+		void deallocate(T*, size_t) {}
+
+		YellowstoneFrameArena* getArena() const { return arena; }
+
+		template <typename U>
+		bool operator==(const FrameAllocator<U>& other) const { return arena == other.getArena(); }
+		template <typename U>
+		bool operator!=(const FrameAllocator<U>& other) const { return arena != other.getArena(); }
+
+	private:
+		YellowstoneFrameArena* arena;
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
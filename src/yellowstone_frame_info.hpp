@@ -3,15 +3,15 @@
 #include <vulkan/vulkan.h>
 
 #include "yellowstone_camera.hpp"
-#include "yellowstone_game_object.hpp"
+#include "systems/render_snapshot.hpp"
 
 namespace yellowstone {
     struct FrameInfo {
         int frameIndex;
         float frameTime;
         VkCommandBuffer commandBuffer;
-        YellowstoneCamera camera;
+        const YellowstoneCamera& camera;
         VkDescriptorSet descriptorSet;
-        YellowstoneGameObject::Map& gameObjects;
+        const RenderSnapshot& snapshot;
     };
 }
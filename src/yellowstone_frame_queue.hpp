@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace yellowstone {
+
+	// Bounded queue of frames handed from a producing to a consuming thread. Frames are
+	// reused rather than reallocated: the producer fills a free one and publishes it, the
+	// consumer takes published frames in order and gives them back when done. At most
+	// 'depth' published frames wait at a time, so the producer blocks instead of running
+	// further ahead.
+	template <typename T>
+	class YellowstoneFrameQueue {
+	public:
+		explicit YellowstoneFrameQueue(uint32_t depth) : depth{depth}, frames(depth + 2), published(depth) {
+			for (T& frame : frames) {
+				freeFrames.push_back(&frame);
+			}
+		}
+
+		YellowstoneFrameQueue(const YellowstoneFrameQueue&) = delete;
+		YellowstoneFrameQueue& operator=(const YellowstoneFrameQueue&) = delete;
+
+		// Producer side. Returns nullptr once the queue is closed.
+		T* beginWrite() {
+			std::unique_lock<std::mutex> lock{mutex};
+			spaceAvailable.wait(lock, [this]() { return closed || (!freeFrames.empty() && publishedCount < depth); });
+			if (closed) {
+				return nullptr;
+			}
+			T* frame = freeFrames.back();
+			freeFrames.pop_back();
+			return frame;
+		}
+
+		void endWrite(T* frame) {
+			{
+				std::lock_guard<std::mutex> lock{mutex};
+				published[(publishedFirst + publishedCount) % depth] = frame;
+				publishedCount++;
+			}
+			frameAvailable.notify_one();
+		}
+
+		// Consumer side. Returns nullptr if nothing was published within 'timeout' or the
+		// queue is closed.
+		T* beginRead(std::chrono::milliseconds timeout) {
+			std::unique_lock<std::mutex> lock{mutex};
+			if (!frameAvailable.wait_for(lock, timeout, [this]() { return closed || publishedCount > 0; }) || closed) {
+				return nullptr;
+			}
+			T* frame = published[publishedFirst];
+			publishedFirst = (publishedFirst + 1) % depth;
+			publishedCount--;
+			return frame;
+		}
+
+		void endRead(T* frame) {
+			{
+				std::lock_guard<std::mutex> lock{mutex};
+				freeFrames.push_back(frame);
+			}
+			spaceAvailable.notify_one();
+		}
+
+		// Wakes both sides up for shutdown; frames still queued are dropped
+		void close() {
+			{
+				std::lock_guard<std::mutex> lock{mutex};
+				closed = true;
+			}
+			spaceAvailable.notify_all();
+			frameAvailable.notify_all();
+		}
+
+		uint32_t getDepth() const { return depth; }
+		uint32_t getQueuedCount() {
+			std::lock_guard<std::mutex> lock{mutex};
+			return publishedCount;
+		}
+
+	private:
+		const uint32_t depth;
+		// Enough for 'depth' queued frames plus one being written and one being read
+		std::vector<T> frames;
+		std::vector<T*> freeFrames;
+		// Ring of published frames, oldest at 'publishedFirst'
+		std::vector<T*> published;
+		uint32_t publishedFirst = 0;
+		uint32_t publishedCount = 0;
+		bool closed = false;
+
+		std::mutex mutex;
+		std::condition_variable spaceAvailable;
+		std::condition_variable frameAvailable;
+	};
+
+}
@@ -6,6 +6,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
+#include <atomic>
 #include <iostream>
 #include <cassert>
 #include <unordered_map>
@@ -23,9 +24,17 @@ namespace std {
 
 namespace yellowstone {
 
-	YellowstoneModel::YellowstoneModel(YellowstoneDevice &device, const YellowstoneModel::Builder &builder) : yellowstoneDevice{device} {
+	namespace {
+
+		std::atomic<uint32_t> nextMeshId{0};
+
+	}
+
+	YellowstoneModel::YellowstoneModel(YellowstoneDevice &device, const YellowstoneModel::Builder &builder)
+		: yellowstoneDevice{device}, meshId{nextMeshId.fetch_add(1, std::memory_order_relaxed)} {
 		createVertexBuffers(builder.vertices);
 		createIndexBuffers(builder.indices);
+		computeBoundingSphere(builder.vertices);
 	}
 
 	YellowstoneModel::~YellowstoneModel() {}
@@ -89,11 +98,33 @@ namespace yellowstone {
 		yellowstoneDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
 	}
 
-	void YellowstoneModel::draw(VkCommandBuffer commandBuffer) {
+	void YellowstoneModel::computeBoundingSphere(const std::vector<Vertex>& vertices) {
+		if (vertices.empty()) {
+			return;
+		}
+
+		// Centered on the bounding box, which is close enough to the minimal sphere for culling
+		glm::vec3 minimum{vertices[0].position};
+		glm::vec3 maximum{vertices[0].position};
+		for (const auto& vertex : vertices) {
+			minimum = glm::min(minimum, vertex.position);
+			maximum = glm::max(maximum, vertex.position);
+		}
+		glm::vec3 center = 0.5f * (minimum + maximum);
+
+		float radiusSquared = 0.0f;
+		for (const auto& vertex : vertices) {
+			glm::vec3 offset = vertex.position - center;
+			radiusSquared = glm::max(radiusSquared, glm::dot(offset, offset));
+		}
+		boundingSphere = glm::vec4{center, glm::sqrt(radiusSquared)};
+	}
+
+	void YellowstoneModel::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) {
 		if (hasIndexBuffer) {
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+			vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, 0, 0, firstInstance);
 		} else {
-			vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+			vkCmdDraw(commandBuffer, vertexCount, instanceCount, 0, firstInstance);
 		}
 	}
 
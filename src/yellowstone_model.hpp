@@ -43,11 +43,22 @@ namespace yellowstone {
 		static std::unique_ptr<YellowstoneModel> createModelFromFile(YellowstoneDevice& device, const std::string& filepath);
 
 		void bind(VkCommandBuffer commandBuffer);
-		void draw(VkCommandBuffer commandBuffer);
+		// Draws 'instanceCount' copies; gl_InstanceIndex starts at 'firstInstance'
+		void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+		bool hasIndices() const { return hasIndexBuffer; }
+		uint32_t getIndexCount() const { return indexCount; }
+		uint32_t getVertexCount() const { return vertexCount; }
+		// Sphere around every vertex in model space: center in xyz, radius in w
+		const glm::vec4& getBoundingSphere() const { return boundingSphere; }
+		// Unique per model and fixed from creation, in creation order; what
+		// YellowstoneRenderQueue orders draws by
+		uint32_t getMeshId() const { return meshId; }
 	
 	private:
 		void createVertexBuffers(const std::vector<Vertex>& vertices);
 		void createIndexBuffers(const std::vector<uint32_t>& indices);
+		void computeBoundingSphere(const std::vector<Vertex>& vertices);
 
 		YellowstoneDevice& yellowstoneDevice;
 
@@ -57,5 +68,8 @@ namespace yellowstone {
 		bool hasIndexBuffer = false;
 		std::unique_ptr<YellowstoneBuffer> indexBuffer;
 		uint32_t indexCount;
+
+		glm::vec4 boundingSphere{0.0f};
+		uint32_t meshId;
 	};
 }
\ No newline at end of file
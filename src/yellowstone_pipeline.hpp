@@ -39,6 +39,8 @@ namespace yellowstone {
 		void bind(VkCommandBuffer commandBuffer);
 
 	private:
+		friend class YellowstoneComputePipeline;
+
 		static std::vector<char> readFile(const std::string& filepath);
 		void createGraphicsPipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo);
 		void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
@@ -47,4 +49,18 @@ namespace yellowstone {
 		VkShaderModule vertShaderModule;
 		VkShaderModule fragShaderModule;
 	};
+
+	class YellowstoneComputePipeline {
+	public:
+		YellowstoneComputePipeline(YellowstoneDevice& device, const std::string& compFilepath, VkPipelineLayout pipelineLayout);
+		~YellowstoneComputePipeline();
+		YellowstoneComputePipeline(const YellowstoneComputePipeline&) = delete;
+		YellowstoneComputePipeline& operator=(const YellowstoneComputePipeline&) = delete;
+		void bind(VkCommandBuffer commandBuffer);
+
+	private:
+		YellowstoneDevice& yellowstoneDevice;
+		VkPipeline computePipeline;
+		VkShaderModule compShaderModule;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "yellowstone_render_queue.hpp"
+
+namespace yellowstone {
+
+	RenderStats& RenderStats::operator+=(const RenderStats& other) {
+		pipelineBinds += other.pipelineBinds;
+		descriptorBinds += other.descriptorBinds;
+		bufferBinds += other.bufferBinds;
+		draws += other.draws;
+		return *this;
+	}
+
+	void YellowstoneRenderQueue::sort() {
+		constexpr uint32_t passCount = sizeof(uint32_t);
+		uint32_t count = static_cast<uint32_t>(entries.size());
+		if (count < 2) {
+			return;
+		}
+
+		// Histograms of every byte in one read of the mesh IDs
+		uint32_t histograms[passCount][256] = {};
+		for (const Entry& entry : entries) {
+			for (uint32_t pass = 0; pass < passCount; pass++) {
+				histograms[pass][(entry.mesh >> (pass * 8)) & 0xff]++;
+			}
+		}
+
+		scratch.resize(count);
+		for (uint32_t pass = 0; pass < passCount; pass++) {
+			uint32_t* histogram = histograms[pass];
+			uint32_t shift = pass * 8;
+			if (histogram[(entries[0].mesh >> shift) & 0xff] == count) {
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t digit = 0; digit < 256; digit++) {
+				uint32_t digitCount = histogram[digit];
+				histogram[digit] = offset;
+				offset += digitCount;
+			}
+			for (const Entry& entry : entries) {
+				scratch[histogram[(entry.mesh >> shift) & 0xff]++] = entry;
+			}
+			entries.swap(scratch);
+		}
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace yellowstone {
+
+	// Commands recorded by a render system in one frame
+	struct RenderStats {
+		uint32_t pipelineBinds = 0;
+		uint32_t descriptorBinds = 0;
+		uint32_t bufferBinds = 0;
+		uint32_t draws = 0;
+
+		RenderStats& operator+=(const RenderStats& other);
+	};
+
+	// Draws ordered by the mesh they use, YellowstoneModel::getMeshId(), so the order is the
+	// same every frame whatever order the draws were queued in. It orders by nothing else: the
+	// draws queued so far share one pipeline and set of descriptors and are one per mesh.
+	class YellowstoneRenderQueue {
+	public:
+		struct Entry {
+			uint32_t mesh;
+			// Index of the draw in the caller's own list
+			uint32_t draw;
+		};
+
+		void clear() { entries.clear(); }
+		void push(uint32_t mesh, uint32_t draw) { entries.push_back({mesh, draw}); }
+		// Stable LSD radix sort, a byte per pass. Passes over a byte every mesh ID shares are
+		// skipped, so a queue of a few hundred meshes takes only two.
+		void sort();
+
+		uint32_t size() const { return static_cast<uint32_t>(entries.size()); }
+		bool empty() const { return entries.empty(); }
+		const Entry& operator[](uint32_t index) const { return entries[index]; }
+
+	private:
+		std::vector<Entry> entries;
+		std::vector<Entry> scratch;
+	};
+
+}
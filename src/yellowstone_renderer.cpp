@@ -1,4 +1,5 @@
 #include "yellowstone_renderer.hpp"
+#include "yellowstone_frame_arena.hpp"
 
 #include <stdexcept>
 #include <cassert>
@@ -6,12 +7,15 @@
 
 namespace yellowstone {
 
+	static_assert(YellowstoneFrameArena::maxFramesInFlight == YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT, "One frame arena per frame in flight");
+
 	YellowstoneRenderer::YellowstoneRenderer(YellowstoneWindow& window, YellowstoneDevice& device) : yellowstoneWindow{window}, yellowstoneDevice{device} {
 		recreateSwapChain();
 		createCommandBuffers();
 	}
 
 	YellowstoneRenderer::~YellowstoneRenderer() {
+		freeSecondaryCommandBuffers();
 		freeCommandBuffers();
 	}
 
@@ -56,6 +60,16 @@ namespace yellowstone {
 		commandBuffers.clear();
 	}
 
+	void YellowstoneRenderer::freeSecondaryCommandBuffers() {
+		// Destroying a pool frees the buffers allocated from it
+		for (auto& frame : secondaryCommandBuffers) {
+			for (VkCommandPool pool : frame.pools) {
+				vkDestroyCommandPool(yellowstoneDevice.device(), pool, nullptr);
+			}
+		}
+		secondaryCommandBuffers.clear();
+	}
+
 	VkCommandBuffer YellowstoneRenderer::beginFrame() {
 		assert(!isFrameStarted && "Frame already started!");
 		auto result = yellowstoneSwapChain->acquireNextImage(&currentImageIndex);
@@ -68,6 +82,14 @@ namespace yellowstone {
 		}
 
 		isFrameStarted = true;
+		// The image's fence has been waited on, so nothing from this frame slot's last use is live
+		YellowstoneFrameArena::beginFrame(static_cast<uint32_t>(currentFrameIndex));
+		if (!secondaryCommandBuffers.empty()) {
+			for (VkCommandPool pool : secondaryCommandBuffers[currentFrameIndex].pools) {
+				vkResetCommandPool(yellowstoneDevice.device(), pool, 0);
+			}
+		}
+		secondaryCount = 0;
 		auto commandBuffer = getCurrentFrameCommandBuffer();
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -97,7 +119,7 @@ namespace yellowstone {
 		currentFrameIndex = (currentFrameIndex + 1) % YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT;
 	}
 
-	void YellowstoneRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+	void YellowstoneRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
 		assert(isFrameStarted && "Frame not started!");
 		assert(commandBuffer == getCurrentFrameCommandBuffer() && "CommandBuffer is not the current frame command buffer!");
 
@@ -114,8 +136,15 @@ namespace yellowstone {
 		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+		isRenderPassSecondary = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS;
+		// Nothing but vkCmdExecuteCommands may be recorded inline in a secondary render pass
+		if (!isRenderPassSecondary) {
+			setViewportAndScissor(commandBuffer);
+		}
+	}
 
+	void YellowstoneRenderer::setViewportAndScissor(VkCommandBuffer commandBuffer) {
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -132,7 +161,77 @@ namespace yellowstone {
 		assert(isFrameStarted && "Frame not started!");
 		assert(commandBuffer == getCurrentFrameCommandBuffer() && "CommandBuffer is not the current frame command buffer!");
 
+		if (isRenderPassSecondary && secondaryCount > 0) {
+			vkCmdExecuteCommands(commandBuffer, secondaryCount, secondaryCommandBuffers[currentFrameIndex].buffers.data());
+		}
+		assert((isRenderPassSecondary || secondaryCount == 0) && "Secondary command buffers need a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS");
 		vkCmdEndRenderPass(commandBuffer);
+		isRenderPassSecondary = false;
+	}
+
+	uint32_t YellowstoneRenderer::reserveSecondaryCommandBuffers(uint32_t count) {
+		assert(isFrameStarted && "Frame not started!");
+		if (secondaryCommandBuffers.empty()) {
+			secondaryCommandBuffers.resize(YellowstoneSwapChain::MAX_FRAMES_IN_FLIGHT);
+		}
+
+		uint32_t first = secondaryCount;
+		secondaryCount += count;
+		// Buffers are only ever added, so after the first frames this allocates nothing
+		auto& frame = secondaryCommandBuffers[currentFrameIndex];
+		while (frame.buffers.size() < secondaryCount) {
+			VkCommandPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = yellowstoneDevice.findPhysicalQueueFamilies().graphicsFamily;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			VkCommandPool pool;
+			if (vkCreateCommandPool(yellowstoneDevice.device(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create secondary command pool!");
+			}
+			frame.pools.push_back(pool);
+
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocInfo.commandPool = pool;
+			allocInfo.commandBufferCount = 1;
+			VkCommandBuffer buffer;
+			if (vkAllocateCommandBuffers(yellowstoneDevice.device(), &allocInfo, &buffer) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate secondary command buffer!");
+			}
+			frame.buffers.push_back(buffer);
+		}
+		return first;
+	}
+
+	VkCommandBuffer YellowstoneRenderer::beginSecondaryCommandBuffer(uint32_t index) {
+		assert(isFrameStarted && "Frame not started!");
+		assert(index < secondaryCount && "Secondary command buffer was not reserved this frame!");
+		VkCommandBuffer commandBuffer = secondaryCommandBuffers[currentFrameIndex].buffers[index];
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = yellowstoneSwapChain->getRenderPass();
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = yellowstoneSwapChain->getFrameBuffer(currentImageIndex);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin secondary command buffer!");
+		}
+
+		// Dynamic state isn't inherited from the primary buffer
+		setViewportAndScissor(commandBuffer);
+		return commandBuffer;
+	}
+
+	void YellowstoneRenderer::endSecondaryCommandBuffer(VkCommandBuffer commandBuffer) {
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record secondary command buffer!");
+		}
 	}
 
 
@@ -33,20 +33,46 @@ namespace yellowstone {
 
         VkCommandBuffer beginFrame();
         void endFrame();
-        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+        // With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, everything inside the render pass
+        // has to be recorded into secondary command buffers from reserveSecondaryCommandBuffers()
+        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+        // Executes the secondary command buffers reserved this frame, if any, then ends the render pass
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
+        // Reserves 'count' secondary command buffers for the current frame and returns the index
+        // of the first. They are executed in the order reserved. Not thread safe; reserve from
+        // one thread, then record the reserved buffers from as many as needed.
+        uint32_t reserveSecondaryCommandBuffers(uint32_t count);
+        // Begins secondary command buffer 'index' inside the swap chain render pass, with the
+        // viewport and scissor set. Each has its own command pool, so different indices can be
+        // recorded on different threads at the same time.
+        VkCommandBuffer beginSecondaryCommandBuffer(uint32_t index);
+        void endSecondaryCommandBuffer(VkCommandBuffer commandBuffer);
+
     private:
+        // A command pool per secondary buffer and frame in flight. Pools of the current frame
+        // are reset together once its fence has been waited on.
+        struct SecondaryCommandBuffers {
+            std::vector<VkCommandPool> pools;
+            std::vector<VkCommandBuffer> buffers;
+        };
+
         void createCommandBuffers();
         void freeCommandBuffers();
+        void freeSecondaryCommandBuffers();
         void recreateSwapChain();
+        void setViewportAndScissor(VkCommandBuffer commandBuffer);
 
         YellowstoneWindow& yellowstoneWindow;
         YellowstoneDevice& yellowstoneDevice;
         std::unique_ptr<YellowstoneSwapChain> yellowstoneSwapChain;
         std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<SecondaryCommandBuffers> secondaryCommandBuffers;
+        // Secondary buffers reserved in the current frame
+        uint32_t secondaryCount = 0;
         uint32_t currentImageIndex;
         int currentFrameIndex = 0;
         bool isFrameStarted = false;
+        bool isRenderPassSecondary = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace yellowstone {
+
+	// Packs a slot index (low 32 bits) and the slot's generation (high 32 bits)
+	using SlotMapHandle = uint64_t;
+
+	// Stores values contiguously and hands out generational handles to them. Erasing swaps
+	// the last value into the hole, so iteration is always a walk over a dense array; the
+	// slot's generation is bumped so stale handles to a recycled slot stop resolving.
+	// Pointers to values are invalidated by insert and erase, handles are not.
+	template <typename T>
+	class YellowstoneSlotMap {
+	public:
+		using Handle = SlotMapHandle;
+		static constexpr Handle invalidHandle = ~Handle{0};
+
+		Handle insert(T&& value) {
+			uint32_t index;
+			if (freeHead != endOfList) {
+				index = freeHead;
+				freeHead = slots[index].denseIndex;
+			} else {
+				index = static_cast<uint32_t>(slots.size());
+				slots.push_back({0, 0});
+			}
+
+			slots[index].denseIndex = static_cast<uint32_t>(values.size());
+			values.push_back(std::move(value));
+			denseToSlot.push_back(index);
+			version++;
+			return makeHandle(index, slots[index].generation);
+		}
+
+		bool erase(Handle handle) {
+			if (!contains(handle)) {
+				return false;
+			}
+
+			uint32_t index = slotIndex(handle);
+			uint32_t dense = slots[index].denseIndex;
+			uint32_t last = static_cast<uint32_t>(values.size()) - 1;
+			if (dense != last) {
+				values[dense] = std::move(values[last]);
+				denseToSlot[dense] = denseToSlot[last];
+				slots[denseToSlot[dense]].denseIndex = dense;
+			}
+			values.pop_back();
+			denseToSlot.pop_back();
+
+			slots[index].generation++;
+			slots[index].denseIndex = freeHead;
+			freeHead = index;
+			version++;
+			return true;
+		}
+
+		bool contains(Handle handle) const {
+			uint32_t index = slotIndex(handle);
+			// Erasing bumps the generation, so a free slot never matches a handle handed out before
+			return index < slots.size() && slots[index].generation == generation(handle);
+		}
+
+		T* get(Handle handle) { return contains(handle) ? &values[slots[slotIndex(handle)].denseIndex] : nullptr; }
+		const T* get(Handle handle) const { return contains(handle) ? &values[slots[slotIndex(handle)].denseIndex] : nullptr; }
+
+		// Handle of the value at a position in iteration order
+		Handle getHandle(size_t denseIndex) const {
+			uint32_t index = denseToSlot[denseIndex];
+			return makeHandle(index, slots[index].generation);
+		}
+
+		void clear() {
+			// Erase one by one so every slot's generation moves on
+			while (!values.empty()) {
+				erase(getHandle(values.size() - 1));
+			}
+		}
+
+		void reserve(size_t count) {
+			values.reserve(count);
+			denseToSlot.reserve(count);
+			slots.reserve(count);
+		}
+
+		size_t size() const { return values.size(); }
+		bool empty() const { return values.empty(); }
+		// Changes whenever a value is inserted or erased
+		uint64_t getVersion() const { return version; }
+
+		typename std::vector<T>::iterator begin() { return values.begin(); }
+		typename std::vector<T>::iterator end() { return values.end(); }
+		typename std::vector<T>::const_iterator begin() const { return values.begin(); }
+		typename std::vector<T>::const_iterator end() const { return values.end(); }
+
+	private:
+		struct Slot {
+			// Position in 'values' while live, next free slot while free
+			uint32_t denseIndex;
+			uint32_t generation;
+		};
+
+		static constexpr uint32_t endOfList = ~uint32_t{0};
+
+		static Handle makeHandle(uint32_t index, uint32_t generation) {
+			return (static_cast<Handle>(generation) << 32) | index;
+		}
+		static uint32_t slotIndex(Handle handle) { return static_cast<uint32_t>(handle); }
+		static uint32_t generation(Handle handle) { return static_cast<uint32_t>(handle >> 32); }
+
+		std::vector<T> values;
+		std::vector<uint32_t> denseToSlot;
+		std::vector<Slot> slots;
+		uint32_t freeHead = endOfList;
+		uint64_t version = 0;
+	};
+
+}
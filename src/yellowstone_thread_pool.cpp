@@ -0,0 +1,392 @@
+#include "yellowstone_thread_pool.hpp"
+#include "yellowstone_frame_arena.hpp"
+
+#include <algorithm>
+
+namespace yellowstone {
+
+	namespace {
+
+		// Jobs a thread's cache trades with the shared list at a time
+		constexpr uint32_t jobCacheBatch = 16;
+
+		// Set on worker threads, so jobs they submit go to their own deque
+		thread_local YellowstoneThreadPool* currentPool = nullptr;
+		thread_local uint32_t currentWorker = 0;
+
+		uint32_t nextRandom() {
+			thread_local uint32_t state = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+	}
+
+	YellowstoneThreadPool::WorkStealingDeque::WorkStealingDeque() : buffer{new std::atomic<Job*>[capacity]} {}
+
+	bool YellowstoneThreadPool::WorkStealingDeque::push(Job* job) {
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= capacity) {
+			return false;
+		}
+		buffer[b & (capacity - 1)].store(job, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+
+	YellowstoneThreadPool::Job* YellowstoneThreadPool::WorkStealingDeque::pop() {
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = buffer[b & (capacity - 1)].load(std::memory_order_relaxed);
+		if (t == b) {
+			// Last job; race any thief for it
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	YellowstoneThreadPool::Job* YellowstoneThreadPool::WorkStealingDeque::steal() {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b) {
+			return nullptr;
+		}
+
+		Job* job = buffer[t & (capacity - 1)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+	uint32_t YellowstoneThreadPool::defaultWorkerCount() {
+		uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+		return hardwareThreads - 1;
+	}
+
+	YellowstoneThreadPool::YellowstoneThreadPool(uint32_t workerCount) {
+		deques.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			deques.push_back(std::make_unique<WorkStealingDeque>());
+		}
+		workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			workers.emplace_back([this, i]() { workerLoop(i); });
+		}
+	}
+
+	YellowstoneThreadPool::~YellowstoneThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock{sleepMutex};
+			stopping = true;
+		}
+		workAvailable.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		// Anything still queued was never waited for; drop it without running
+		while (injectedHead != nullptr) {
+			Job* job = injectedHead;
+			injectedHead = job->next;
+			job->invoke(*job, false);
+			freeJob(job);
+		}
+		for (auto& deque : deques) {
+			while (Job* job = deque->pop()) {
+				job->invoke(*job, false);
+				freeJob(job);
+			}
+		}
+	}
+
+	struct YellowstoneThreadPool::SharedJobList {
+		std::mutex mutex;
+		Job* head = nullptr;
+
+		~SharedJobList() {
+			while (head != nullptr) {
+				Job* job = head;
+				head = job->next;
+				delete job;
+			}
+		}
+	};
+
+	struct YellowstoneThreadPool::JobCache {
+		Job* head = nullptr;
+		uint32_t count = 0;
+
+		~JobCache() {
+			SharedJobList& shared = sharedJobs();
+			std::lock_guard<std::mutex> lock{shared.mutex};
+			while (head != nullptr) {
+				Job* job = head;
+				head = job->next;
+				job->next = shared.head;
+				shared.head = job;
+			}
+		}
+	};
+
+	YellowstoneThreadPool::SharedJobList& YellowstoneThreadPool::sharedJobs() {
+		static SharedJobList list;
+		return list;
+	}
+
+	YellowstoneThreadPool::JobCache& YellowstoneThreadPool::threadJobCache() {
+		thread_local JobCache cache;
+		return cache;
+	}
+
+	YellowstoneThreadPool::Job* YellowstoneThreadPool::allocateJob() {
+		JobCache& jobCache = threadJobCache();
+		if (jobCache.head == nullptr) {
+			SharedJobList& shared = sharedJobs();
+			std::lock_guard<std::mutex> lock{shared.mutex};
+			while (shared.head != nullptr && jobCache.count < jobCacheBatch) {
+				Job* job = shared.head;
+				shared.head = job->next;
+				job->next = jobCache.head;
+				jobCache.head = job;
+				jobCache.count++;
+			}
+		}
+		if (jobCache.head == nullptr) {
+			// Grow a batch at a time, so the pool reaches its working size in a few steps
+			for (uint32_t i = 0; i < jobCacheBatch; i++) {
+				Job* job = new Job{};
+				job->next = jobCache.head;
+				jobCache.head = job;
+				jobCache.count++;
+			}
+		}
+		Job* job = jobCache.head;
+		jobCache.head = job->next;
+		jobCache.count--;
+		return job;
+	}
+
+	void YellowstoneThreadPool::freeJob(Job* job) {
+		JobCache& jobCache = threadJobCache();
+		job->next = jobCache.head;
+		jobCache.head = job;
+		jobCache.count++;
+		if (jobCache.count < 2 * jobCacheBatch) {
+			return;
+		}
+
+		// Hand a batch back so threads that mostly submit can pick it up
+		Job* first = jobCache.head;
+		Job* last = first;
+		for (uint32_t i = 1; i < jobCacheBatch; i++) {
+			last = last->next;
+		}
+		jobCache.head = last->next;
+		jobCache.count -= jobCacheBatch;
+
+		SharedJobList& shared = sharedJobs();
+		std::lock_guard<std::mutex> lock{shared.mutex};
+		last->next = shared.head;
+		shared.head = first;
+	}
+
+	void YellowstoneThreadPool::enqueueAfter(JobCounter& dependency, Job* job) {
+		{
+			std::lock_guard<std::mutex> lock{dependency.continuationMutex};
+			if (dependency.pending.load(std::memory_order_acquire) != 0) {
+				job->next = dependency.continuations;
+				dependency.continuations = job;
+				return;
+			}
+		}
+		enqueue(job);
+	}
+
+	void YellowstoneThreadPool::enqueue(Job* job) {
+		// Counted before it is visible so the count never drops below zero. Pairs with the
+		// check in workerLoop: either the worker sees this job or we see it sleeping.
+		queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+		bool pushed = currentPool == this && deques[currentWorker]->push(job);
+		if (!pushed) {
+			std::lock_guard<std::mutex> lock{injectedMutex};
+			job->next = nullptr;
+			if (injectedTail != nullptr) {
+				injectedTail->next = job;
+			} else {
+				injectedHead = job;
+			}
+			injectedTail = job;
+			injectedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+			std::lock_guard<std::mutex> lock{sleepMutex};
+			workAvailable.notify_one();
+		}
+	}
+
+	void YellowstoneThreadPool::wait(JobCounter& counter) {
+		while (!counter.isDone()) {
+			if (!runOneJob()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	YellowstoneThreadPool::Job* YellowstoneThreadPool::findJob() {
+		if (currentPool == this) {
+			if (Job* job = deques[currentWorker]->pop()) {
+				return job;
+			}
+		}
+
+		if (injectedCount.load(std::memory_order_relaxed) > 0) {
+			std::lock_guard<std::mutex> lock{injectedMutex};
+			if (injectedHead != nullptr) {
+				Job* job = injectedHead;
+				injectedHead = job->next;
+				if (injectedHead == nullptr) {
+					injectedTail = nullptr;
+				}
+				injectedCount.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+
+		// Start at a random victim so thieves don't all hammer the same deque
+		uint32_t dequeCount = static_cast<uint32_t>(deques.size());
+		uint32_t start = dequeCount > 0 ? nextRandom() % dequeCount : 0;
+		for (uint32_t i = 0; i < dequeCount; i++) {
+			uint32_t victim = (start + i) % dequeCount;
+			if (currentPool == this && victim == currentWorker) {
+				continue;
+			}
+			if (Job* job = deques[victim]->steal()) {
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	bool YellowstoneThreadPool::runOneJob() {
+		Job* job = findJob();
+		if (job == nullptr) {
+			return false;
+		}
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		execute(job);
+		return true;
+	}
+
+	void YellowstoneThreadPool::execute(Job* job) {
+		{
+			// Whatever a job takes from the thread's frame arena is released when it returns;
+			// results that must outlive it belong in memory the submitter provides
+			FrameArenaScope arenaScope;
+			AllocationScope allocationScope{job->allocationScope};
+			job->invoke(*job, true);
+		}
+		JobCounter* counter = job->counter;
+		freeJob(job);
+		if (counter != nullptr) {
+			finishJob(*counter);
+		}
+	}
+
+	void YellowstoneThreadPool::finishJob(JobCounter& counter) {
+		// 'finishing' keeps wait() from returning, and the counter alive, until we're done with it
+		counter.finishing.fetch_add(1, std::memory_order_seq_cst);
+		if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Job* ready;
+			{
+				std::lock_guard<std::mutex> lock{counter.continuationMutex};
+				ready = counter.continuations;
+				counter.continuations = nullptr;
+			}
+			while (ready != nullptr) {
+				Job* job = ready;
+				ready = job->next;
+				enqueue(job);
+			}
+		}
+		counter.finishing.fetch_sub(1, std::memory_order_release);
+	}
+
+	void YellowstoneThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& task) {
+		parallelFor(0, count, 1, [&task](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				task(i);
+			}
+		});
+	}
+
+	void YellowstoneThreadPool::parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& task) {
+		if (begin >= end) {
+			return;
+		}
+		grainSize = std::max(grainSize, 1u);
+		if (workers.empty() || end - begin <= grainSize) {
+			task(begin, end);
+			return;
+		}
+
+		JobCounter counter;
+		splitRange(begin, end, grainSize, task, counter);
+		wait(counter);
+	}
+
+	void YellowstoneThreadPool::splitRange(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& task, JobCounter& counter) {
+		// Offer the upper half to thieves and keep splitting the lower half here
+		while (end - begin > grainSize) {
+			uint32_t middle = begin + (end - begin) / 2;
+			submit([this, middle, end, grainSize, &task, &counter]() {
+				splitRange(middle, end, grainSize, task, counter);
+			}, &counter);
+			end = middle;
+		}
+		task(begin, end);
+	}
+
+	void YellowstoneThreadPool::workerLoop(uint32_t index) {
+		currentPool = this;
+		currentWorker = index;
+		const int spinCount = 64;
+
+		while (!stopping.load(std::memory_order_relaxed)) {
+			if (runOneJob()) {
+				continue;
+			}
+
+			bool found = false;
+			for (int i = 0; i < spinCount && !found; i++) {
+				std::this_thread::yield();
+				found = runOneJob();
+			}
+			if (found) {
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock{sleepMutex};
+			sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+			workAvailable.wait(lock, [this]() {
+				return stopping.load(std::memory_order_relaxed) || queuedJobs.load(std::memory_order_seq_cst) > 0;
+			});
+			sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "yellowstone_allocation_tracker.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace yellowstone {
+
+	class YellowstoneThreadPool;
+
+	// Counts submitted jobs that haven't finished yet. Wait on it with
+	// YellowstoneThreadPool::wait() before destroying it.
+	class JobCounter {
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool isDone() const {
+			return pending.load(std::memory_order_acquire) == 0 && finishing.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		friend class YellowstoneThreadPool;
+		struct Job;
+
+		std::atomic<uint32_t> pending{0};
+		// Jobs between decrementing 'pending' and releasing their last reference to the counter
+		std::atomic<uint32_t> finishing{0};
+		std::mutex continuationMutex;
+		// Submitted by the job that brings 'pending' to zero, linked through Job::next
+		Job* continuations = nullptr;
+	};
+
+	// Callables up to 'inlineSize' bytes are stored in the job itself and jobs are recycled
+	// through free lists, so submitting doesn't touch the heap once the pool has warmed up
+	struct JobCounter::Job {
+		static constexpr size_t inlineSize = 48;
+
+		alignas(std::max_align_t) unsigned char storage[inlineSize];
+		// Runs the stored callable if 'run' is set, then destroys it
+		void (*invoke)(Job& job, bool run);
+		JobCounter* counter;
+		// The submitter's AllocationScope, reinstated while the job runs
+		const char* allocationScope;
+		Job* next;
+	};
+
+	// Work-stealing job system. Every worker owns a deque it pushes and pops jobs at one end
+	// of, while idle workers steal from the other end. Threads that aren't workers submit into
+	// a shared queue, and any thread waiting on a counter runs jobs until it is done, so the
+	// calling thread always takes part. Jobs must not throw.
+	class YellowstoneThreadPool {
+	public:
+		// Defaults to one worker per hardware thread, minus the calling thread
+		static uint32_t defaultWorkerCount();
+
+		explicit YellowstoneThreadPool(uint32_t workerCount = defaultWorkerCount());
+		~YellowstoneThreadPool();
+
+		YellowstoneThreadPool(const YellowstoneThreadPool&) = delete;
+		YellowstoneThreadPool& operator=(const YellowstoneThreadPool&) = delete;
+
+		uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+		// Queues 'job', counted by 'counter' if there is one
+		template <typename F>
+		void submit(F&& job, JobCounter* counter = nullptr) {
+			enqueue(createJob(std::forward<F>(job), counter));
+		}
+		// Queues 'job' once every job counted by 'dependency' has finished
+		template <typename F>
+		void submitAfter(JobCounter& dependency, F&& job, JobCounter* counter = nullptr) {
+			enqueueAfter(dependency, createJob(std::forward<F>(job), counter));
+		}
+		// Runs queued jobs on the calling thread until 'counter' is done
+		void wait(JobCounter& counter);
+
+		// Calls task(index) for every index in [0, count) and returns once all are done
+		void parallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+		// Calls task(rangeBegin, rangeEnd) over pieces of [begin, end) no larger than
+		// 'grainSize'. The range is split in halves as workers steal, so large pieces are
+		// handed out first.
+		void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& task);
+
+	private:
+		using Job = JobCounter::Job;
+
+		// Chase-Lev deque of fixed capacity: the owning worker pushes and pops at the bottom,
+		// any thread may steal from the top
+		class WorkStealingDeque {
+		public:
+			WorkStealingDeque();
+			bool push(Job* job);
+			Job* pop();
+			Job* steal();
+
+		private:
+			static constexpr int64_t capacity = 4096;
+			std::atomic<int64_t> top{0};
+			std::atomic<int64_t> bottom{0};
+			std::unique_ptr<std::atomic<Job*>[]> buffer;
+		};
+
+		template <typename F>
+		static Job* createJob(F&& function, JobCounter* counter) {
+			using Callable = std::decay_t<F>;
+			Job* job = allocateJob();
+			if constexpr (sizeof(Callable) <= Job::inlineSize && alignof(Callable) <= alignof(std::max_align_t)) {
+				new (job->storage) Callable(std::forward<F>(function));
+				job->invoke = [](Job& job, bool run) {
+					Callable* callable = std::launder(reinterpret_cast<Callable*>(job.storage));
+					if (run) {
+						(*callable)();
+					}
+					callable->~Callable();
+				};
+			} else {
+				new (job->storage) Callable*(new Callable(std::forward<F>(function)));
+				job->invoke = [](Job& job, bool run) {
+					Callable* callable = *std::launder(reinterpret_cast<Callable**>(job.storage));
+					if (run) {
+						(*callable)();
+					}
+					delete callable;
+				};
+			}
+			job->counter = counter;
+			job->allocationScope = AllocationScope::current();
+			if (counter != nullptr) {
+				counter->pending.fetch_add(1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+		// Jobs are the same size whichever pool runs them, so one set of free lists serves
+		// all pools. Each thread keeps a cache and trades batches with the shared list, which
+		// keeps jobs flowing back when they are created on one thread and freed on another.
+		struct JobCache;
+		struct SharedJobList;
+		static SharedJobList& sharedJobs();
+		static JobCache& threadJobCache();
+		static Job* allocateJob();
+		static void freeJob(Job* job);
+
+		void enqueue(Job* job);
+		void enqueueAfter(JobCounter& dependency, Job* job);
+		bool runOneJob();
+		Job* findJob();
+		void execute(Job* job);
+		void finishJob(JobCounter& counter);
+		void splitRange(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& task, JobCounter& counter);
+		void workerLoop(uint32_t index);
+
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+
+		// Jobs submitted from threads that aren't workers, or that didn't fit a worker's deque,
+		// queued first in first out through Job::next
+		std::mutex injectedMutex;
+		Job* injectedHead = nullptr;
+		Job* injectedTail = nullptr;
+		std::atomic<uint32_t> injectedCount{0};
+
+		// Jobs queued anywhere but not yet picked up; workers only sleep while it is zero
+		std::atomic<uint32_t> queuedJobs{0};
+		std::atomic<uint32_t> sleepingWorkers{0};
+		std::mutex sleepMutex;
+		std::condition_variable workAvailable;
+		std::atomic<bool> stopping{false};
+	};
+
+}
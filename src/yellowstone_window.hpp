@@ -18,6 +18,7 @@ namespace yellowstone {
 		bool wasWindowResized() { return framebufferResized; }
 		void resetWindowResizedFlag() { framebufferResized = false; }
 		GLFWwindow* getWindow() { return window; }
+		void setTitle(const char* title) { glfwSetWindowTitle(window, title); }
 
 	private:
 		static void framebufferResizeCallback(GLFWwindow* window, int width, int height);